@@ -0,0 +1,1019 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Zero-copy camera preview
+ *
+ * Exports the V4L2 capture buffers as dmabufs, imports them into the
+ * display as framebuffers and flips them straight onto a KMS plane of
+ * the panel's CRTC, scaled to fit by the display pipeline. The frames
+ * are never touched by the CPU or the GPU: each buffer goes back to the
+ * camera once the next one is on screen.
+ *
+ * The capture device has to produce a format the plane can scan out
+ * (YUYV, UYVY, NV12, YU12, RGB565, BGR3 or XR24) in buffers the display
+ * can import. vc4 needs physically contiguous buffers, so on the CM4
+ * this means a dma-contig V4L2 driver such as the bcm2835-isp outputs;
+ * the legacy bcm2835-v4l2 camera allocates with vmalloc and its buffers
+ * are rejected on import.
+ *
+ * Off-device, vivid and vkms will do:
+ *   modprobe vivid; modprobe vkms enable_overlay=1
+ *   camera-preview --video /dev/videoN --format XR24 --size 640x360
+ * vkms can't scale, the preview is then shown at 1:1 in the middle.
+ *
+ * Build: gcc -O2 -Wall $(pkg-config --cflags libdrm) -o camera-preview
+ *            camera-preview.c $(pkg-config --libs libdrm)
+ * Usage: camera-preview [--video DEV] [--format FOURCC] [--size WxH]
+ *                       [--buffers N] [--card DEV] [--connector ID]
+ *                       [--primary] [--count N]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/videodev2.h>
+
+#include <drm_fourcc.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#define MAX_BUFFERS	8
+
+struct format {
+	uint32_t v4l2;
+	uint32_t drm;
+};
+
+/* V4L2 pixel formats that have a KMS equivalent with the same layout */
+static const struct format formats[] = {
+	{ V4L2_PIX_FMT_YUYV, DRM_FORMAT_YUYV },
+	{ V4L2_PIX_FMT_UYVY, DRM_FORMAT_UYVY },
+	{ V4L2_PIX_FMT_NV12, DRM_FORMAT_NV12 },
+	{ V4L2_PIX_FMT_YUV420, DRM_FORMAT_YUV420 },
+	{ V4L2_PIX_FMT_RGB565, DRM_FORMAT_RGB565 },
+	{ V4L2_PIX_FMT_BGR24, DRM_FORMAT_RGB888 },
+	{ V4L2_PIX_FMT_XBGR32, DRM_FORMAT_XRGB8888 },
+};
+
+struct frame {
+	int dmabuf;
+	uint32_t handle;
+	uint32_t fb;
+	/* Capture timestamp, in us */
+	double captured_us;
+};
+
+struct camera {
+	int fd;
+	uint32_t width, height;
+	uint32_t bytesperline;
+	uint32_t pixelformat;
+	uint32_t drm_format;
+	struct frame frames[MAX_BUFFERS];
+	unsigned int count;
+	int streaming;
+};
+
+struct plane_props {
+	uint32_t fb_id, crtc_id;
+	uint32_t src_x, src_y, src_w, src_h;
+	uint32_t crtc_x, crtc_y, crtc_w, crtc_h;
+};
+
+struct display {
+	int fd;
+	uint32_t crtc;
+	int crtc_index;
+	uint32_t connector;
+	drmModeModeInfo mode;
+	drmModeCrtc *saved;
+	/* Black buffer on the primary plane, under the preview */
+	uint32_t black_handle, black_fb;
+	uint32_t plane;
+	struct plane_props props;
+	/* Preview rectangle: source in 16.16, destination in pixels */
+	uint32_t src_x, src_y, src_w, src_h;
+	int32_t dst_x, dst_y;
+	uint32_t dst_w, dst_h;
+	int plane_set;
+};
+
+/* Frame indices, -1 when none */
+struct queue {
+	int next;	/* captured, waiting for the flip in flight */
+	int pending;	/* flip requested */
+	int shown;	/* on screen */
+};
+
+struct counters {
+	unsigned int captured;
+	unsigned int shown;
+	unsigned int dropped;
+	unsigned int timed;
+	double latency_sum_us;
+	double latency_max_us;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static int xioctl(int fd, unsigned long req, void *arg)
+{
+	int ret;
+
+	do {
+		ret = ioctl(fd, req, arg);
+	} while (ret < 0 && errno == EINTR);
+
+	return ret;
+}
+
+static const struct format *find_format(uint32_t v4l2)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+		if (formats[i].v4l2 == v4l2)
+			return &formats[i];
+
+	return NULL;
+}
+
+static void fourcc_str(uint32_t f, char *s)
+{
+	s[0] = f & 0xff;
+	s[1] = (f >> 8) & 0xff;
+	s[2] = (f >> 16) & 0xff;
+	s[3] = f >> 24;
+	s[4] = '\0';
+}
+
+static int open_camera(struct camera *cam, const char *path, uint32_t fourcc,
+		       uint32_t width, uint32_t height)
+{
+	struct v4l2_capability cap = { 0 };
+	struct v4l2_format fmt = { .type = V4L2_BUF_TYPE_VIDEO_CAPTURE };
+	const struct format *f;
+	char name[5];
+
+	cam->fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (cam->fd < 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	if (xioctl(cam->fd, VIDIOC_QUERYCAP, &cap) ||
+	    !(cap.device_caps & V4L2_CAP_VIDEO_CAPTURE) ||
+	    !(cap.device_caps & V4L2_CAP_STREAMING)) {
+		fprintf(stderr, "%s: not a single-planar streaming capture "
+			"device\n", path);
+		return -1;
+	}
+
+	if (xioctl(cam->fd, VIDIOC_G_FMT, &fmt)) {
+		fprintf(stderr, "%s: VIDIOC_G_FMT: %s\n", path,
+			strerror(errno));
+		return -1;
+	}
+
+	if (fourcc)
+		fmt.fmt.pix.pixelformat = fourcc;
+	if (width && height) {
+		fmt.fmt.pix.width = width;
+		fmt.fmt.pix.height = height;
+	}
+	fmt.fmt.pix.field = V4L2_FIELD_NONE;
+	/* Let the driver pick the stride */
+	fmt.fmt.pix.bytesperline = 0;
+
+	if (xioctl(cam->fd, VIDIOC_S_FMT, &fmt)) {
+		fprintf(stderr, "%s: VIDIOC_S_FMT: %s\n", path,
+			strerror(errno));
+		return -1;
+	}
+
+	fourcc_str(fmt.fmt.pix.pixelformat, name);
+	f = find_format(fmt.fmt.pix.pixelformat);
+	if (!f) {
+		fprintf(stderr, "%s: the device gave %s, which can't be "
+			"scanned out\n", path, name);
+		return -1;
+	}
+	if (fourcc && fourcc != fmt.fmt.pix.pixelformat)
+		fprintf(stderr, "%s: using %s instead\n", path, name);
+
+	cam->width = fmt.fmt.pix.width;
+	cam->height = fmt.fmt.pix.height;
+	cam->bytesperline = fmt.fmt.pix.bytesperline;
+	cam->pixelformat = fmt.fmt.pix.pixelformat;
+	cam->drm_format = f->drm;
+
+	printf("%s: %s, %s %ux%u, stride %u\n", path, cap.card, name,
+	       cam->width, cam->height, cam->bytesperline);
+
+	return 0;
+}
+
+static int pick_connector(struct display *d, drmModeRes *res,
+			  uint32_t wanted)
+{
+	drmModeConnector *best = NULL;
+	int i;
+
+	for (i = 0; i < res->count_connectors; i++) {
+		drmModeConnector *c = drmModeGetConnector(d->fd,
+							  res->connectors[i]);
+
+		if (!c)
+			continue;
+
+		if (c->connection != DRM_MODE_CONNECTED || !c->count_modes ||
+		    (wanted && c->connector_id != wanted) ||
+		    (best && (best->connector_type == DRM_MODE_CONNECTOR_DSI ||
+			      c->connector_type != DRM_MODE_CONNECTOR_DSI))) {
+			drmModeFreeConnector(c);
+			continue;
+		}
+
+		if (best)
+			drmModeFreeConnector(best);
+		best = c;
+	}
+
+	if (!best)
+		return -ENODEV;
+
+	d->connector = best->connector_id;
+	d->mode = best->modes[0];
+	for (i = 0; i < best->count_modes; i++)
+		if (best->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+			d->mode = best->modes[i];
+			break;
+		}
+
+	/* Any CRTC the connector's encoders can drive */
+	d->crtc = 0;
+	for (i = 0; i < best->count_encoders && !d->crtc; i++) {
+		drmModeEncoder *e = drmModeGetEncoder(d->fd, best->encoders[i]);
+		int j;
+
+		if (!e)
+			continue;
+
+		if (e->crtc_id)
+			d->crtc = e->crtc_id;
+		for (j = 0; j < res->count_crtcs && !d->crtc; j++)
+			if (e->possible_crtcs & (1 << j))
+				d->crtc = res->crtcs[j];
+		drmModeFreeEncoder(e);
+	}
+	drmModeFreeConnector(best);
+
+	for (i = 0; i < res->count_crtcs; i++)
+		if (res->crtcs[i] == d->crtc)
+			d->crtc_index = i;
+
+	return d->crtc ? 0 : -ENODEV;
+}
+
+static uint32_t get_prop(int fd, uint32_t id, uint32_t type,
+			 const char *name, uint64_t *value)
+{
+	drmModeObjectProperties *props;
+	uint32_t prop = 0;
+	uint32_t i;
+
+	props = drmModeObjectGetProperties(fd, id, type);
+	if (!props)
+		return 0;
+
+	for (i = 0; i < props->count_props && !prop; i++) {
+		drmModePropertyRes *p = drmModeGetProperty(fd, props->props[i]);
+
+		if (!p)
+			continue;
+		if (!strcmp(p->name, name)) {
+			prop = p->prop_id;
+			if (value)
+				*value = props->prop_values[i];
+		}
+		drmModeFreeProperty(p);
+	}
+	drmModeFreeObjectProperties(props);
+
+	return prop;
+}
+
+/*
+ * An overlay plane of the CRTC that takes the format, or the primary
+ * plane with --primary
+ */
+static int pick_plane(struct display *d, uint32_t format, int primary)
+{
+	uint64_t wanted = primary ? DRM_PLANE_TYPE_PRIMARY :
+				    DRM_PLANE_TYPE_OVERLAY;
+	drmModePlaneRes *res;
+	uint32_t i, j;
+
+	res = drmModeGetPlaneResources(d->fd);
+	if (!res)
+		return -errno;
+
+	d->plane = 0;
+	for (i = 0; i < res->count_planes && !d->plane; i++) {
+		drmModePlane *p = drmModeGetPlane(d->fd, res->planes[i]);
+		uint64_t type = 0;
+
+		if (!p)
+			continue;
+
+		get_prop(d->fd, p->plane_id, DRM_MODE_OBJECT_PLANE, "type",
+			 &type);
+		if (type == wanted &&
+		    (p->possible_crtcs & (1 << d->crtc_index)))
+			for (j = 0; j < p->count_formats; j++)
+				if (p->formats[j] == format)
+					d->plane = p->plane_id;
+		drmModeFreePlane(p);
+	}
+	drmModeFreePlaneResources(res);
+
+	if (!d->plane)
+		return -ENODEV;
+
+#define PLANE_PROP(field, name)						\
+	do {								\
+		d->props.field = get_prop(d->fd, d->plane,		\
+					  DRM_MODE_OBJECT_PLANE, name,	\
+					  NULL);			\
+		if (!d->props.field)					\
+			return -ENOENT;					\
+	} while (0)
+
+	PLANE_PROP(fb_id, "FB_ID");
+	PLANE_PROP(crtc_id, "CRTC_ID");
+	PLANE_PROP(src_x, "SRC_X");
+	PLANE_PROP(src_y, "SRC_Y");
+	PLANE_PROP(src_w, "SRC_W");
+	PLANE_PROP(src_h, "SRC_H");
+	PLANE_PROP(crtc_x, "CRTC_X");
+	PLANE_PROP(crtc_y, "CRTC_Y");
+	PLANE_PROP(crtc_w, "CRTC_W");
+	PLANE_PROP(crtc_h, "CRTC_H");
+
+#undef PLANE_PROP
+
+	return 0;
+}
+
+static int create_black(struct display *d)
+{
+	struct drm_mode_create_dumb create = {
+		.width = d->mode.hdisplay,
+		.height = d->mode.vdisplay,
+		.bpp = 32,
+	};
+
+	/* Dumb buffers are zeroed on creation */
+	if (drmIoctl(d->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create))
+		return -errno;
+	d->black_handle = create.handle;
+
+	if (drmModeAddFB(d->fd, d->mode.hdisplay, d->mode.vdisplay, 24, 32,
+			 create.pitch, create.handle, &d->black_fb))
+		return -errno;
+
+	return 0;
+}
+
+static int open_display(struct display *d, const char *card,
+			uint32_t connector)
+{
+	drmModeRes *res;
+	char path[64];
+	int i, ret;
+
+	for (i = 0; i < 16; i++) {
+		if (card)
+			snprintf(path, sizeof(path), "%s", card);
+		else
+			snprintf(path, sizeof(path), "/dev/dri/card%d", i);
+
+		d->fd = open(path, O_RDWR | O_CLOEXEC);
+		if (d->fd < 0) {
+			if (card)
+				break;
+			continue;
+		}
+
+		/* Atomic, which also exposes every plane */
+		if (drmSetClientCap(d->fd, DRM_CLIENT_CAP_ATOMIC, 1)) {
+			ret = -EOPNOTSUPP;
+		} else {
+			res = drmModeGetResources(d->fd);
+			ret = res ? pick_connector(d, res, connector) : -ENODEV;
+			if (res)
+				drmModeFreeResources(res);
+		}
+		if (!ret)
+			break;
+
+		close(d->fd);
+		d->fd = -1;
+		if (card)
+			break;
+	}
+
+	if (d->fd < 0) {
+		fprintf(stderr, "no usable atomic display found\n");
+		return -1;
+	}
+
+	ret = create_black(d);
+	if (ret) {
+		fprintf(stderr, "can't create the background: %s\n",
+			strerror(-ret));
+		return -1;
+	}
+
+	d->saved = drmModeGetCrtc(d->fd, d->crtc);
+
+	if (drmModeSetCrtc(d->fd, d->crtc, d->black_fb, 0, 0, &d->connector,
+			   1, &d->mode)) {
+		fprintf(stderr, "can't set the mode (is a compositor "
+			"running?): %s\n", strerror(errno));
+		return -1;
+	}
+
+	printf("%s: connector %u, crtc %u, %ux%u@%u\n", path, d->connector,
+	       d->crtc, d->mode.hdisplay, d->mode.vdisplay, d->mode.vrefresh);
+
+	return 0;
+}
+
+static void disable_plane(struct display *d)
+{
+	drmModeAtomicReq *req;
+
+	if (!d->plane_set)
+		return;
+
+	req = drmModeAtomicAlloc();
+	if (!req)
+		return;
+
+	drmModeAtomicAddProperty(req, d->plane, d->props.fb_id, 0);
+	drmModeAtomicAddProperty(req, d->plane, d->props.crtc_id, 0);
+	drmModeAtomicCommit(d->fd, req, 0, NULL);
+	drmModeAtomicFree(req);
+	d->plane_set = 0;
+}
+
+static void close_display(struct display *d)
+{
+	struct drm_mode_destroy_dumb destroy = { .handle = d->black_handle };
+
+	if (d->saved) {
+		drmModeSetCrtc(d->fd, d->saved->crtc_id, d->saved->buffer_id,
+			       d->saved->x, d->saved->y, &d->connector, 1,
+			       &d->saved->mode);
+		drmModeFreeCrtc(d->saved);
+	}
+
+	if (d->black_fb)
+		drmModeRmFB(d->fd, d->black_fb);
+	if (d->black_handle)
+		drmIoctl(d->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+
+	close(d->fd);
+}
+
+/* Turn a capture buffer into a framebuffer, without a copy */
+static int import_frame(struct display *d, struct camera *cam,
+			unsigned int index)
+{
+	struct v4l2_exportbuffer exp = {
+		.type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+		.index = index,
+		.flags = O_RDONLY | O_CLOEXEC,
+	};
+	struct frame *f = &cam->frames[index];
+	uint32_t handles[4] = { 0 }, pitches[4] = { 0 }, offsets[4] = { 0 };
+	uint32_t stride = cam->bytesperline, h = cam->height;
+
+	if (xioctl(cam->fd, VIDIOC_EXPBUF, &exp)) {
+		fprintf(stderr, "VIDIOC_EXPBUF: %s\n", strerror(errno));
+		return -1;
+	}
+	f->dmabuf = exp.fd;
+
+	if (drmPrimeFDToHandle(d->fd, f->dmabuf, &f->handle)) {
+		fprintf(stderr, "the display can't import the capture "
+			"buffers: %s\n", strerror(errno));
+		return -1;
+	}
+
+	/* All the planes are in the one buffer, one after another */
+	handles[0] = f->handle;
+	pitches[0] = stride;
+	switch (cam->drm_format) {
+	case DRM_FORMAT_NV12:
+		handles[1] = f->handle;
+		pitches[1] = stride;
+		offsets[1] = stride * h;
+		break;
+	case DRM_FORMAT_YUV420:
+		handles[1] = handles[2] = f->handle;
+		pitches[1] = pitches[2] = stride / 2;
+		offsets[1] = stride * h;
+		offsets[2] = offsets[1] + stride / 2 * (h / 2);
+		break;
+	}
+
+	if (drmModeAddFB2(d->fd, cam->width, cam->height, cam->drm_format,
+			  handles, pitches, offsets, &f->fb, 0)) {
+		fprintf(stderr, "can't create a framebuffer from the capture "
+			"buffers: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int start_camera(struct camera *cam, struct display *d,
+			unsigned int count)
+{
+	struct v4l2_requestbuffers req = {
+		.count = count,
+		.type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+		.memory = V4L2_MEMORY_MMAP,
+	};
+	int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	unsigned int i;
+
+	if (xioctl(cam->fd, VIDIOC_REQBUFS, &req)) {
+		fprintf(stderr, "VIDIOC_REQBUFS: %s\n", strerror(errno));
+		return -1;
+	}
+	/* One on screen, one flipping, one waiting, one capturing */
+	if (req.count < 4) {
+		fprintf(stderr, "only %u capture buffers\n", req.count);
+		return -1;
+	}
+	cam->count = req.count < MAX_BUFFERS ? req.count : MAX_BUFFERS;
+
+	for (i = 0; i < cam->count; i++)
+		cam->frames[i].dmabuf = -1;
+
+	for (i = 0; i < cam->count; i++) {
+		struct v4l2_buffer buf = {
+			.type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+			.memory = V4L2_MEMORY_MMAP,
+			.index = i,
+		};
+
+		if (import_frame(d, cam, i))
+			return -1;
+
+		if (xioctl(cam->fd, VIDIOC_QBUF, &buf)) {
+			fprintf(stderr, "VIDIOC_QBUF: %s\n", strerror(errno));
+			return -1;
+		}
+	}
+
+	if (xioctl(cam->fd, VIDIOC_STREAMON, &type)) {
+		fprintf(stderr, "VIDIOC_STREAMON: %s\n", strerror(errno));
+		return -1;
+	}
+	cam->streaming = 1;
+
+	return 0;
+}
+
+static void stop_camera(struct camera *cam, struct display *d)
+{
+	struct v4l2_requestbuffers req = {
+		.type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+		.memory = V4L2_MEMORY_MMAP,
+	};
+	int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	unsigned int i;
+
+	if (cam->streaming)
+		xioctl(cam->fd, VIDIOC_STREAMOFF, &type);
+
+	for (i = 0; i < cam->count; i++) {
+		struct frame *f = &cam->frames[i];
+		struct drm_gem_close gem = { .handle = f->handle };
+
+		if (f->fb)
+			drmModeRmFB(d->fd, f->fb);
+		if (f->handle)
+			drmIoctl(d->fd, DRM_IOCTL_GEM_CLOSE, &gem);
+		if (f->dmabuf >= 0)
+			close(f->dmabuf);
+	}
+
+	xioctl(cam->fd, VIDIOC_REQBUFS, &req);
+	close(cam->fd);
+}
+
+static int requeue(struct camera *cam, int index)
+{
+	struct v4l2_buffer buf = {
+		.type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+		.memory = V4L2_MEMORY_MMAP,
+		.index = index,
+	};
+
+	if (xioctl(cam->fd, VIDIOC_QBUF, &buf)) {
+		fprintf(stderr, "VIDIOC_QBUF: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Scale to fit the screen, keeping the aspect ratio */
+static void fit(struct display *d, struct camera *cam)
+{
+	uint32_t mw = d->mode.hdisplay, mh = d->mode.vdisplay;
+
+	d->src_x = d->src_y = 0;
+	d->src_w = cam->width << 16;
+	d->src_h = cam->height << 16;
+
+	if ((uint64_t)cam->width * mh > (uint64_t)cam->height * mw) {
+		d->dst_w = mw;
+		d->dst_h = (uint64_t)cam->height * mw / cam->width;
+	} else {
+		d->dst_h = mh;
+		d->dst_w = (uint64_t)cam->width * mh / cam->height;
+	}
+	d->dst_x = (mw - d->dst_w) / 2;
+	d->dst_y = (mh - d->dst_h) / 2;
+}
+
+/* For planes that can't scale: the middle of the frame at 1:1 */
+static void unscaled(struct display *d, struct camera *cam)
+{
+	uint32_t mw = d->mode.hdisplay, mh = d->mode.vdisplay;
+	uint32_t w = cam->width < mw ? cam->width : mw;
+	uint32_t h = cam->height < mh ? cam->height : mh;
+
+	d->src_x = ((cam->width - w) / 2) << 16;
+	d->src_y = ((cam->height - h) / 2) << 16;
+	d->src_w = w << 16;
+	d->src_h = h << 16;
+	d->dst_w = w;
+	d->dst_h = h;
+	d->dst_x = (mw - w) / 2;
+	d->dst_y = (mh - h) / 2;
+}
+
+static int commit(struct display *d, uint32_t fb, uint32_t flags,
+		  void *data)
+{
+	drmModeAtomicReq *req = drmModeAtomicAlloc();
+	int ret;
+
+	if (!req)
+		return -ENOMEM;
+
+	drmModeAtomicAddProperty(req, d->plane, d->props.fb_id, fb);
+	/* The geometry only has to be set once */
+	if (!d->plane_set || (flags & DRM_MODE_ATOMIC_TEST_ONLY)) {
+		drmModeAtomicAddProperty(req, d->plane, d->props.crtc_id,
+					 d->crtc);
+		drmModeAtomicAddProperty(req, d->plane, d->props.src_x,
+					 d->src_x);
+		drmModeAtomicAddProperty(req, d->plane, d->props.src_y,
+					 d->src_y);
+		drmModeAtomicAddProperty(req, d->plane, d->props.src_w,
+					 d->src_w);
+		drmModeAtomicAddProperty(req, d->plane, d->props.src_h,
+					 d->src_h);
+		drmModeAtomicAddProperty(req, d->plane, d->props.crtc_x,
+					 d->dst_x);
+		drmModeAtomicAddProperty(req, d->plane, d->props.crtc_y,
+					 d->dst_y);
+		drmModeAtomicAddProperty(req, d->plane, d->props.crtc_w,
+					 d->dst_w);
+		drmModeAtomicAddProperty(req, d->plane, d->props.crtc_h,
+					 d->dst_h);
+	}
+
+	ret = drmModeAtomicCommit(d->fd, req, flags, data) ? -errno : 0;
+	drmModeAtomicFree(req);
+
+	if (!ret && !(flags & DRM_MODE_ATOMIC_TEST_ONLY))
+		d->plane_set = 1;
+
+	return ret;
+}
+
+static int setup_plane(struct display *d, struct camera *cam)
+{
+	fit(d, cam);
+	if (!commit(d, cam->frames[0].fb, DRM_MODE_ATOMIC_TEST_ONLY, NULL))
+		goto done;
+
+	unscaled(d, cam);
+	if (commit(d, cam->frames[0].fb, DRM_MODE_ATOMIC_TEST_ONLY, NULL)) {
+		fprintf(stderr, "plane %u rejects the preview\n", d->plane);
+		return -1;
+	}
+	printf("plane %u can't scale, showing the middle at 1:1\n",
+	       d->plane);
+
+done:
+	printf("plane %u: %ux%u+%u+%u to %ux%u+%d+%d\n", d->plane,
+	       d->src_w >> 16, d->src_h >> 16, d->src_x >> 16, d->src_y >> 16,
+	       d->dst_w, d->dst_h, d->dst_x, d->dst_y);
+
+	return 0;
+}
+
+static int flip(struct display *d, struct camera *cam, struct queue *q)
+{
+	int ret;
+
+	ret = commit(d, cam->frames[q->next].fb,
+		     DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT,
+		     cam);
+	if (ret) {
+		fprintf(stderr, "page flip failed: %s\n", strerror(-ret));
+		return -1;
+	}
+
+	q->pending = q->next;
+	q->next = -1;
+
+	return 0;
+}
+
+static struct queue queue = { -1, -1, -1 };
+static struct counters counters;
+
+static void page_flip_handler(int fd, unsigned int frame, unsigned int sec,
+			      unsigned int usec, void *data)
+{
+	struct camera *cam = data;
+	double latency;
+
+	(void)fd;
+	(void)frame;
+
+	/* The previous frame is off screen, the camera can have it back */
+	if (queue.shown >= 0)
+		requeue(cam, queue.shown);
+	queue.shown = queue.pending;
+	queue.pending = -1;
+
+	counters.shown++;
+
+	if (!cam->frames[queue.shown].captured_us)
+		return;
+	latency = sec * 1e6 + usec - cam->frames[queue.shown].captured_us;
+	counters.latency_sum_us += latency;
+	if (latency > counters.latency_max_us)
+		counters.latency_max_us = latency;
+	counters.timed++;
+}
+
+static int dequeue(struct camera *cam)
+{
+	struct v4l2_buffer buf = {
+		.type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+		.memory = V4L2_MEMORY_MMAP,
+	};
+
+	if (xioctl(cam->fd, VIDIOC_DQBUF, &buf))
+		return errno == EAGAIN ? -EAGAIN : -errno;
+
+	/* Latency is only meaningful against the vblank clock */
+	if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) ==
+	    V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+		cam->frames[buf.index].captured_us =
+			buf.timestamp.tv_sec * 1e6 + buf.timestamp.tv_usec;
+	else
+		cam->frames[buf.index].captured_us = 0;
+
+	return buf.index;
+}
+
+static double cpu_ms(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+
+	return ru.ru_utime.tv_sec * 1e3 + ru.ru_utime.tv_usec / 1e3 +
+	       ru.ru_stime.tv_sec * 1e3 + ru.ru_stime.tv_usec / 1e3;
+}
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [--video DEV] [--format FOURCC] [--size WxH] "
+		"[--buffers N] [--card DEV] [--connector ID] [--primary] "
+		"[--count N]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{ "video", required_argument, NULL, 'v' },
+		{ "format", required_argument, NULL, 'f' },
+		{ "size", required_argument, NULL, 's' },
+		{ "buffers", required_argument, NULL, 'b' },
+		{ "card", required_argument, NULL, 'c' },
+		{ "connector", required_argument, NULL, 'C' },
+		{ "primary", no_argument, NULL, 'p' },
+		{ "count", required_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ },
+	};
+	drmEventContext evctx = {
+		.version = 2,
+		.page_flip_handler = page_flip_handler,
+	};
+	struct camera cam = { .fd = -1 };
+	struct display d = { .fd = -1 };
+	const char *video = "/dev/video0", *card = NULL;
+	unsigned int buffers = 4, count = 0, width = 0, height = 0;
+	uint32_t fourcc = 0, connector = 0;
+	double start_ms, start_cpu, elapsed;
+	int primary = 0, ret = 1;
+	int c;
+
+	while ((c = getopt_long(argc, argv, "v:f:s:b:c:C:pn:h", options,
+				NULL)) != -1) {
+		switch (c) {
+		case 'v':
+			video = optarg;
+			break;
+		case 'f':
+			if (strlen(optarg) != 4) {
+				usage(argv[0]);
+				return 1;
+			}
+			fourcc = v4l2_fourcc(optarg[0], optarg[1], optarg[2],
+					     optarg[3]);
+			break;
+		case 's':
+			if (sscanf(optarg, "%ux%u", &width, &height) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'b':
+			buffers = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			card = optarg;
+			break;
+		case 'C':
+			connector = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			primary = 1;
+			break;
+		case 'n':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc || buffers < 4 || buffers > MAX_BUFFERS) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (open_camera(&cam, video, fourcc, width, height))
+		goto out_camera;
+
+	if (open_display(&d, card, connector))
+		goto out_display;
+
+	if (pick_plane(&d, cam.drm_format, primary)) {
+		char name[5];
+
+		fourcc_str(cam.drm_format, name);
+		fprintf(stderr, "no %s plane on crtc %u takes %s\n",
+			primary ? "primary" : "overlay", d.crtc, name);
+		goto out_display;
+	}
+
+	if (start_camera(&cam, &d, buffers))
+		goto out_stream;
+
+	if (setup_plane(&d, &cam))
+		goto out_stream;
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	start_ms = now_ms();
+	start_cpu = cpu_ms();
+
+	while (!stop && (!count || counters.shown < count)) {
+		struct pollfd fds[2] = {
+			{ .fd = cam.fd, .events = POLLIN },
+			{ .fd = d.fd, .events = POLLIN },
+		};
+		int index;
+
+		if (poll(fds, 2, 2000) <= 0) {
+			if (!stop)
+				fprintf(stderr, "no frame for 2 s, giving "
+					"up\n");
+			break;
+		}
+
+		if (fds[1].revents & POLLIN)
+			drmHandleEvent(d.fd, &evctx);
+
+		while ((index = dequeue(&cam)) >= 0) {
+			counters.captured++;
+			/* Only the latest frame is worth showing */
+			if (queue.next >= 0) {
+				if (requeue(&cam, queue.next))
+					goto out_stream;
+				counters.dropped++;
+			}
+			queue.next = index;
+		}
+		if (index != -EAGAIN) {
+			fprintf(stderr, "VIDIOC_DQBUF: %s\n", strerror(-index));
+			break;
+		}
+
+		if (queue.next >= 0 && queue.pending < 0 &&
+		    flip(&d, &cam, &queue))
+			break;
+	}
+
+	elapsed = now_ms() - start_ms;
+	printf("%u frames captured, %u shown, %u dropped in %.1f s "
+	       "(%.1f fps shown)\n", counters.captured, counters.shown,
+	       counters.dropped, elapsed / 1e3,
+	       elapsed > 0 ? counters.shown * 1e3 / elapsed : 0);
+	if (counters.timed)
+		printf("capture to scanout: mean %.1f ms, max %.1f ms\n",
+		       counters.latency_sum_us / counters.timed / 1e3,
+		       counters.latency_max_us / 1e3);
+	if (counters.shown)
+		printf("CPU time: %.3f ms per frame shown\n",
+		       (cpu_ms() - start_cpu) / counters.shown);
+
+	ret = counters.shown ? 0 : 1;
+
+out_stream:
+	/* Wait for the last flip, its buffer is still being scanned out */
+	while (queue.pending >= 0) {
+		struct pollfd pfd = { .fd = d.fd, .events = POLLIN };
+
+		if (poll(&pfd, 1, 1000) <= 0)
+			break;
+		drmHandleEvent(d.fd, &evctx);
+	}
+	disable_plane(&d);
+	stop_camera(&cam, &d);
+	cam.fd = -1;
+out_display:
+	if (d.fd >= 0)
+		close_display(&d);
+out_camera:
+	if (cam.fd >= 0)
+		close(cam.fd);
+
+	return ret;
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * DSI transfer recorder for the panel drivers, see panel-dsi-trace.h
+ */
+
+#include <linux/debugfs.h>
+#include <linux/device.h>
+#include <linux/export.h>
+#include <linux/fs.h>
+#include <linux/mm.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+
+#include "panel-dsi-trace.h"
+
+struct panel_dsi_trace_snapshot {
+	size_t	size;
+	u8	data[];
+};
+
+/* Copy the ring out so that readers never block the writers */
+static int panel_dsi_trace_open(struct inode *inode, struct file *file)
+{
+	struct panel_dsi_trace *trace = inode->i_private;
+	struct panel_dsi_trace_snapshot *snap;
+	struct panel_dsi_trace_header *hdr;
+	struct panel_dsi_trace_entry *out;
+	unsigned int head, first, seq;
+	unsigned int count = 0, lost;
+
+	snap = kvzalloc(sizeof(*snap) + sizeof(*hdr) +
+			PANEL_DSI_TRACE_ENTRIES * sizeof(*out), GFP_KERNEL);
+	if (!snap)
+		return -ENOMEM;
+
+	hdr = (struct panel_dsi_trace_header *)snap->data;
+	out = (struct panel_dsi_trace_entry *)(hdr + 1);
+
+	head = atomic_read(&trace->head);
+	first = head > PANEL_DSI_TRACE_ENTRIES ?
+		head - PANEL_DSI_TRACE_ENTRIES : 0;
+	lost = first;
+
+	for (seq = first + 1; seq <= head; seq++) {
+		struct panel_dsi_trace_entry *entry =
+			&trace->ring[(seq - 1) & (PANEL_DSI_TRACE_ENTRIES - 1)];
+
+		if (le32_to_cpu(smp_load_acquire(&entry->seq)) != seq) {
+			lost++;
+			continue;
+		}
+
+		memcpy(&out[count], entry, sizeof(*entry));
+		smp_rmb();
+
+		/* Overwritten while we were copying it */
+		if (le32_to_cpu(READ_ONCE(entry->seq)) != seq) {
+			lost++;
+			continue;
+		}
+
+		count++;
+	}
+
+	hdr->magic = cpu_to_le32(PANEL_DSI_TRACE_MAGIC);
+	hdr->version = cpu_to_le16(PANEL_DSI_TRACE_VERSION);
+	hdr->entry_size = cpu_to_le16(sizeof(*out));
+	hdr->count = cpu_to_le32(count);
+	hdr->lost = cpu_to_le32(lost);
+	hdr->lanes = cpu_to_le32(trace->dsi->lanes);
+	hdr->mode_flags = cpu_to_le32(trace->dsi->mode_flags);
+
+	snap->size = sizeof(*hdr) + count * sizeof(*out);
+	file->private_data = snap;
+
+	return 0;
+}
+
+static ssize_t panel_dsi_trace_read(struct file *file, char __user *buf,
+				    size_t count, loff_t *ppos)
+{
+	struct panel_dsi_trace_snapshot *snap = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, snap->data,
+				       snap->size);
+}
+
+static int panel_dsi_trace_release(struct inode *inode, struct file *file)
+{
+	kvfree(file->private_data);
+	return 0;
+}
+
+static const struct file_operations panel_dsi_trace_fops = {
+	.owner		= THIS_MODULE,
+	.open		= panel_dsi_trace_open,
+	.read		= panel_dsi_trace_read,
+	.release	= panel_dsi_trace_release,
+	.llseek		= default_llseek,
+};
+
+static void panel_dsi_trace_remove(void *data)
+{
+	struct panel_dsi_trace *trace = data;
+
+	debugfs_remove_recursive(trace->debugfs);
+}
+
+/*
+ * The recorder is a debugging aid: if it can't be set up the panel
+ * works just the same, the transfers are simply not recorded.
+ */
+void panel_dsi_trace_init(struct panel_dsi_trace *trace,
+			  struct mipi_dsi_device *dsi, bool enable)
+{
+	struct device *dev = &dsi->dev;
+	char name[64];
+
+	trace->dsi = dsi;
+	trace->enabled = enable;
+	atomic_set(&trace->head, 0);
+
+	trace->ring = devm_kcalloc(dev, PANEL_DSI_TRACE_ENTRIES,
+				   sizeof(*trace->ring), GFP_KERNEL);
+	if (!trace->ring)
+		return;
+
+	snprintf(name, sizeof(name), "dsi-trace.%s", dev_name(dev));
+	trace->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_bool("enable", 0600, trace->debugfs, &trace->enabled);
+	debugfs_create_file("trace", 0400, trace->debugfs, trace,
+			    &panel_dsi_trace_fops);
+
+	if (devm_add_action_or_reset(dev, panel_dsi_trace_remove, trace))
+		trace->debugfs = NULL;
+}
+EXPORT_SYMBOL_GPL(panel_dsi_trace_init);
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * DSI transfer recorder for the panel drivers
+ *
+ * Every transfer going through the panel_dsi_trace_*() helpers is logged
+ * in a per device ring buffer: DSI data type, payload, LP/HS mode, start
+ * time, duration and result. Recording is off by default, it is turned on
+ * through the drivers' dsi_trace module parameter to catch the first
+ * bring-up, or later through debugfs:
+ *
+ *   echo 1 > /sys/kernel/debug/dsi-trace.<device>/enable
+ *   cat /sys/kernel/debug/dsi-trace.<device>/trace > trace.bin
+ *
+ * The trace file is a struct panel_dsi_trace_header followed by count
+ * struct panel_dsi_trace_entry, oldest first, all little endian. It can
+ * be decoded and replayed with Display/tools/dsi-replay.
+ *
+ * Writers don't take any lock: each one claims a slot with an atomic
+ * increment and publishes it by writing its sequence number last.
+ * Readers skip the slots that are being rewritten and count them as lost.
+ */
+
+#ifndef _PANEL_DSI_TRACE_H_
+#define _PANEL_DSI_TRACE_H_
+
+#include <linux/atomic.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/string.h>
+
+#include <drm/drm_mipi_dsi.h>
+
+#include <video/mipi_display.h>
+
+#define PANEL_DSI_TRACE_MAGIC		0x54495344	/* "DSIT" */
+#define PANEL_DSI_TRACE_VERSION		1
+
+/* Must be a power of two */
+#define PANEL_DSI_TRACE_ENTRIES		512
+#define PANEL_DSI_TRACE_PAYLOAD		16
+
+/* The transfer was sent in LP mode */
+#define PANEL_DSI_TRACE_LP		BIT(0)
+/* DCS read: payload is the command followed by the bytes read */
+#define PANEL_DSI_TRACE_READ		BIT(1)
+
+struct panel_dsi_trace_header {
+	__le32	magic;
+	__le16	version;
+	__le16	entry_size;
+	__le32	count;
+	/* Entries overwritten before they could be read */
+	__le32	lost;
+	__le32	lanes;
+	__le32	mode_flags;
+} __packed;
+
+struct panel_dsi_trace_entry {
+	/* 0 while the slot is being written */
+	__le32	seq;
+	__le32	result;
+	__le64	start_ns;
+	__le32	duration_ns;
+	u8	type;
+	u8	flags;
+	/* Length of the whole payload, it is truncated in the trace */
+	__le16	len;
+	u8	payload[PANEL_DSI_TRACE_PAYLOAD];
+} __packed;
+
+struct panel_dsi_trace {
+	struct mipi_dsi_device		*dsi;
+	struct panel_dsi_trace_entry	*ring;
+	atomic_t			head;
+	bool				enabled;
+	struct dentry			*debugfs;
+};
+
+static inline bool panel_dsi_trace_enabled(struct panel_dsi_trace *trace)
+{
+	return trace->ring && READ_ONCE(trace->enabled);
+}
+
+static inline void panel_dsi_trace_record(struct panel_dsi_trace *trace,
+					  u8 type, u8 flags, u8 cmd,
+					  const void *data, size_t len,
+					  ktime_t start, ssize_t result)
+{
+	struct panel_dsi_trace_entry *entry;
+	unsigned int seq;
+	size_t size;
+
+	seq = atomic_inc_return(&trace->head);
+	entry = &trace->ring[(seq - 1) & (PANEL_DSI_TRACE_ENTRIES - 1)];
+
+	WRITE_ONCE(entry->seq, 0);
+	smp_wmb();
+
+	if (trace->dsi->mode_flags & MIPI_DSI_MODE_LPM)
+		flags |= PANEL_DSI_TRACE_LP;
+
+	entry->result = cpu_to_le32(result);
+	entry->start_ns = cpu_to_le64(ktime_to_ns(start));
+	entry->duration_ns = cpu_to_le32(ktime_to_ns(ktime_sub(ktime_get(),
+							       start)));
+	entry->type = type;
+	entry->flags = flags;
+	entry->len = cpu_to_le16(len + 1);
+
+	size = min_t(size_t, len, PANEL_DSI_TRACE_PAYLOAD - 1);
+	memset(entry->payload, 0, sizeof(entry->payload));
+	entry->payload[0] = cmd;
+	if (data && size)
+		memcpy(&entry->payload[1], data, size);
+
+	smp_store_release(&entry->seq, cpu_to_le32(seq));
+}
+
+/* Same as mipi_dsi_dcs_write_buffer() */
+static inline ssize_t panel_dsi_trace_dcs_write_buffer(struct panel_dsi_trace *trace,
+						       const void *data,
+						       size_t len)
+{
+	const u8 *buf = data;
+	ktime_t start;
+	ssize_t ret;
+	u8 type;
+
+	if (!panel_dsi_trace_enabled(trace) || !len)
+		return mipi_dsi_dcs_write_buffer(trace->dsi, data, len);
+
+	start = ktime_get();
+	ret = mipi_dsi_dcs_write_buffer(trace->dsi, data, len);
+
+	if (len == 1)
+		type = MIPI_DSI_DCS_SHORT_WRITE;
+	else if (len == 2)
+		type = MIPI_DSI_DCS_SHORT_WRITE_PARAM;
+	else
+		type = MIPI_DSI_DCS_LONG_WRITE;
+
+	panel_dsi_trace_record(trace, type, 0, buf[0], buf + 1, len - 1,
+			       start, ret);
+
+	return ret;
+}
+
+/* Same as mipi_dsi_dcs_write(), the payload is limited to 15 bytes */
+static inline ssize_t panel_dsi_trace_dcs_write(struct panel_dsi_trace *trace,
+						u8 cmd, const void *data,
+						size_t len)
+{
+	u8 buf[PANEL_DSI_TRACE_PAYLOAD];
+
+	if (len >= sizeof(buf))
+		return -EINVAL;
+
+	buf[0] = cmd;
+	if (len)
+		memcpy(&buf[1], data, len);
+
+	return panel_dsi_trace_dcs_write_buffer(trace, buf, len + 1);
+}
+
+/* Same as mipi_dsi_dcs_read() */
+static inline ssize_t panel_dsi_trace_dcs_read(struct panel_dsi_trace *trace,
+					       u8 cmd, void *data, size_t len)
+{
+	ktime_t start;
+	ssize_t ret;
+
+	if (!panel_dsi_trace_enabled(trace))
+		return mipi_dsi_dcs_read(trace->dsi, cmd, data, len);
+
+	start = ktime_get();
+	ret = mipi_dsi_dcs_read(trace->dsi, cmd, data, len);
+
+	panel_dsi_trace_record(trace, MIPI_DSI_DCS_READ, PANEL_DSI_TRACE_READ,
+			       cmd, ret > 0 ? data : NULL, len, start, ret);
+
+	return ret;
+}
+
+void panel_dsi_trace_init(struct panel_dsi_trace *trace,
+			  struct mipi_dsi_device *dsi, bool enable);
+
+#endif /* _PANEL_DSI_TRACE_H_ */
@@ -5,17 +5,27 @@
  * Copyright (C) 2021, Penk Chen <penk@cutiepi.io>
  */
 
+#include <linux/backlight.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/device.h>
 #include <linux/err.h>
 #include <linux/errno.h>
 #include <linux/fb.h>
+#include <linux/input.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/of_device.h>
+#include <linux/timer.h>
+#include <linux/workqueue.h>
 
 #include <linux/gpio/consumer.h>
+#include <linux/ktime.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/thermal.h>
 
 #include <drm/drm_mipi_dsi.h>
 #include <drm/drm_modes.h>
@@ -23,774 +33,1800 @@
 
 #include <video/mipi_display.h>
 
-enum ili9881c_op {
-	ILI9881C_SWITCH_PAGE,
-	ILI9881C_COMMAND,
+#include "panel-dsi-trace.h"
+#include "panel-init-script.h"
+#include "panel-jd9366-init.h"
+
+struct ili9881c;
+
+struct ili9881c_desc {
+	const struct panel_init_instr *init;
+	const size_t init_length;
+	/* The first mode is the preferred one */
+	const struct drm_display_mode *modes;
+	unsigned int num_modes;
+	const unsigned flags;
+	/*
+	 * Refresh rate of the low refresh mode used in ambient mode and
+	 * under thermal pressure, 0 if the panel has none
+	 */
+	unsigned int low_refresh;
+	/*
+	 * Time the controller needs after reset before it accepts
+	 * commands, in milliseconds. ILI9881C_RESET_SETTLE_MS if 0.
+	 */
+	unsigned int reset_settle_ms;
+
+	int (*switch_page)(struct ili9881c *ctx, u8 page);
+};
+
+/*
+ * Panels we can tell apart from the content of the DCS RDID1-3
+ * registers (0xda, 0xdb and 0xdc), for the boards that can ship with
+ * more than one of them. Bytes cleared in the mask are ignored.
+ */
+struct ili9881c_id {
+	u8 id[3];
+	u8 mask[3];
+	const struct ili9881c_desc *desc;
+};
+
+enum ili9881c_state {
+	ILI9881C_STATE_OFF,
+	/* Out of reset, waiting for prepare(), see ili9881c_power_work() */
+	ILI9881C_STATE_POWERED,
+	/* Initialized and out of sleep, display off */
+	ILI9881C_STATE_PREPARED,
+	ILI9881C_STATE_ON,
+	ILI9881C_STATE_AMBIENT,
+	ILI9881C_NUM_STATES,
+};
+
+/* Backlight off, then three buckets of a third of the maximum each */
+#define ILI9881C_BL_BUCKETS	4
+
+struct ili9881c_residency {
+	enum ili9881c_state	state;
+	unsigned int		bl_bucket;
+	ktime_t			since;
+
+	u64			state_us[ILI9881C_NUM_STATES];
+	unsigned int		transitions[ILI9881C_NUM_STATES];
+	u64			bl_us[ILI9881C_BL_BUCKETS];
+};
+
+struct ili9881c {
+	struct drm_panel	panel;
+	struct mipi_dsi_device	*dsi;
+	const struct ili9881c_desc	*desc;
+
+	struct regulator	*power;
+	struct gpio_desc	*reset;
+
+	struct panel_dsi_trace	trace;
+
+	/* Fresh out of reset, waiting for ili9881c_power_on() */
+	bool			powered;
+
+	/* Early power up, see ili9881c_power_work() */
+	struct work_struct	power_work;
+	bool			prepared_at_suspend;
+	ktime_t			reset_released;
+
+	/* When the last sleep out command was sent */
+	ktime_t			sleep_out;
+
+	/* Serialises the DRM callbacks against the ESD check */
+	struct mutex		lock;
+	bool			prepared;
+	bool			enabled;
+
+	struct delayed_work	esd_work;
+	unsigned int		esd_checks;
+	unsigned int		esd_sleep_recoveries;
+	unsigned int		esd_page_recoveries;
+	unsigned int		esd_reset_recoveries;
+
+	unsigned int		init_retries;
+	unsigned int		init_failures;
+
+	/* Idle mode and dimmed backlight, see ili9881c_enter_ambient() */
+	bool			ambient;
+	int			ambient_saved_brightness;
+
+	/* Touch wake, see ili9881c_wake_work() */
+	struct work_struct	wake_work;
+	struct delayed_work	wake_timeout;
+	struct input_handler	input_handler;
+	bool			input_registered;
+	unsigned int		touch_wakes;
+
+	/* See ili9881c_cooling_states[] */
+	struct thermal_cooling_device	*cooling;
+	unsigned long		cooling_state;
+	int			max_brightness;
+
+	/* Protected by the lock, see ili9881c_account() */
+	struct ili9881c_residency	res;
+};
+
+/*
+ * Period of the ESD health check, in milliseconds. The check is off by
+ * default; it only runs while the panel is enabled.
+ */
+static unsigned int esd_check_ms;
+module_param(esd_check_ms, uint, 0644);
+MODULE_PARM_DESC(esd_check_ms, "ESD health check period in ms (0 = disabled)");
+
+static bool dsi_trace;
+module_param(dsi_trace, bool, 0444);
+MODULE_PARM_DESC(dsi_trace, "Record the DSI transfers from probe on");
+
+static unsigned int ambient_brightness = 10;
+module_param(ambient_brightness, uint, 0644);
+MODULE_PARM_DESC(ambient_brightness,
+		 "Backlight level in ambient mode, in percent of the maximum");
+
+static bool touch_wake = true;
+module_param(touch_wake, bool, 0644);
+MODULE_PARM_DESC(touch_wake, "Start powering the panel up on touch while it's off");
+
+/*
+ * Power state delays, all of them are handled by ili9881c_exit_sleep()
+ * and ili9881c_display_on().
+ */
+#define ILI9881C_SLEEP_OUT_MS	120
+
+/* Supply ramp up and reset pulse, see ili9881c_reset() */
+#define ILI9881C_POWER_UP_MS		5
+#define ILI9881C_RESET_MS		20
+
+/* Default time the controller needs after reset, see ili9881c_desc */
+#define ILI9881C_RESET_SETTLE_MS	20
+
+/* How long a panel powered up early waits for prepare() */
+#define ILI9881C_WAKE_TIMEOUT_MS	2000
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_LHR050H41)
+static const struct panel_init_instr lhr050h41_init[] = {
+	PANEL_INIT_SWITCH_PAGE_INSTR(3),
+	PANEL_INIT_COMMAND_INSTR(0x01, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x02, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x03, 0x73),
+	PANEL_INIT_COMMAND_INSTR(0x04, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x05, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x06, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x07, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x08, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x09, 0x18),
+	PANEL_INIT_COMMAND_INSTR(0x0a, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x0b, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0c, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x0d, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x0e, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0f, 0x25),
+	PANEL_INIT_COMMAND_INSTR(0x10, 0x25),
+	PANEL_INIT_COMMAND_INSTR(0x11, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x12, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x13, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x14, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x15, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x16, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x17, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x18, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x19, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1a, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1b, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1c, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1d, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1e, 0xC0),
+	PANEL_INIT_COMMAND_INSTR(0x1f, 0x80),
+	PANEL_INIT_COMMAND_INSTR(0x20, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x21, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x23, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x24, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x25, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x27, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x28, 0x33),
+	PANEL_INIT_COMMAND_INSTR(0x29, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x2a, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2b, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2c, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2d, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2e, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2f, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x30, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x32, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x33, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x34, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x35, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x36, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x37, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x38, 0x3C),
+	PANEL_INIT_COMMAND_INSTR(0x39, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3a, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3b, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3c, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3d, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3e, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3f, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x40, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x41, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x42, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x43, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x44, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x50, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0x52, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x67),
+	PANEL_INIT_COMMAND_INSTR(0x54, 0x89),
+	PANEL_INIT_COMMAND_INSTR(0x55, 0xab),
+	PANEL_INIT_COMMAND_INSTR(0x56, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x57, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0x58, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0x59, 0x67),
+	PANEL_INIT_COMMAND_INSTR(0x5a, 0x89),
+	PANEL_INIT_COMMAND_INSTR(0x5b, 0xab),
+	PANEL_INIT_COMMAND_INSTR(0x5c, 0xcd),
+	PANEL_INIT_COMMAND_INSTR(0x5d, 0xef),
+	PANEL_INIT_COMMAND_INSTR(0x5e, 0x11),
+	PANEL_INIT_COMMAND_INSTR(0x5f, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x61, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x62, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x63, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x64, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x65, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x66, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x67, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x68, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x69, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6a, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x6b, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6c, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x6d, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x6e, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x6f, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x70, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x71, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x72, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x73, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x74, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x75, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x76, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x77, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x78, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x79, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7a, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7b, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7c, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7d, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7e, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7f, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x80, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x81, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x82, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x83, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x84, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x85, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x86, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x87, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x88, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x89, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x8A, 0x02),
+	PANEL_INIT_SWITCH_PAGE_INSTR(4),
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x15),
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x22),
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x33),
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0xA4),
+	PANEL_INIT_COMMAND_INSTR(0x8D, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x87, 0xBA),
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x76),
+	PANEL_INIT_COMMAND_INSTR(0xB2, 0xD1),
+	PANEL_INIT_SWITCH_PAGE_INSTR(1),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x0A),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0xDC),
+	PANEL_INIT_COMMAND_INSTR(0x55, 0xA7),
+	PANEL_INIT_COMMAND_INSTR(0x50, 0x78),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x78),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x14),
+	PANEL_INIT_COMMAND_INSTR(0xA0, 0x2A),
+	PANEL_INIT_COMMAND_INSTR(0xA1, 0x39),
+	PANEL_INIT_COMMAND_INSTR(0xA2, 0x46),
+	PANEL_INIT_COMMAND_INSTR(0xA3, 0x0e),
+	PANEL_INIT_COMMAND_INSTR(0xA4, 0x12),
+	PANEL_INIT_COMMAND_INSTR(0xA5, 0x25),
+	PANEL_INIT_COMMAND_INSTR(0xA6, 0x19),
+	PANEL_INIT_COMMAND_INSTR(0xA7, 0x1d),
+	PANEL_INIT_COMMAND_INSTR(0xA8, 0xa6),
+	PANEL_INIT_COMMAND_INSTR(0xA9, 0x1C),
+	PANEL_INIT_COMMAND_INSTR(0xAA, 0x29),
+	PANEL_INIT_COMMAND_INSTR(0xAB, 0x85),
+	PANEL_INIT_COMMAND_INSTR(0xAC, 0x1C),
+	PANEL_INIT_COMMAND_INSTR(0xAD, 0x1B),
+	PANEL_INIT_COMMAND_INSTR(0xAE, 0x51),
+	PANEL_INIT_COMMAND_INSTR(0xAF, 0x22),
+	PANEL_INIT_COMMAND_INSTR(0xB0, 0x2d),
+	PANEL_INIT_COMMAND_INSTR(0xB1, 0x4f),
+	PANEL_INIT_COMMAND_INSTR(0xB2, 0x59),
+	PANEL_INIT_COMMAND_INSTR(0xB3, 0x3F),
+	PANEL_INIT_COMMAND_INSTR(0xC0, 0x2A),
+	PANEL_INIT_COMMAND_INSTR(0xC1, 0x3a),
+	PANEL_INIT_COMMAND_INSTR(0xC2, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0xC3, 0x0e),
+	PANEL_INIT_COMMAND_INSTR(0xC4, 0x11),
+	PANEL_INIT_COMMAND_INSTR(0xC5, 0x24),
+	PANEL_INIT_COMMAND_INSTR(0xC6, 0x1a),
+	PANEL_INIT_COMMAND_INSTR(0xC7, 0x1c),
+	PANEL_INIT_COMMAND_INSTR(0xC8, 0xaa),
+	PANEL_INIT_COMMAND_INSTR(0xC9, 0x1C),
+	PANEL_INIT_COMMAND_INSTR(0xCA, 0x29),
+	PANEL_INIT_COMMAND_INSTR(0xCB, 0x96),
+	PANEL_INIT_COMMAND_INSTR(0xCC, 0x1C),
+	PANEL_INIT_COMMAND_INSTR(0xCD, 0x1B),
+	PANEL_INIT_COMMAND_INSTR(0xCE, 0x51),
+	PANEL_INIT_COMMAND_INSTR(0xCF, 0x22),
+	PANEL_INIT_COMMAND_INSTR(0xD0, 0x2b),
+	PANEL_INIT_COMMAND_INSTR(0xD1, 0x4b),
+	PANEL_INIT_COMMAND_INSTR(0xD2, 0x59),
+	PANEL_INIT_COMMAND_INSTR(0xD3, 0x3F),
+};
+#endif
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_K101_IM2BYL02)
+static const struct panel_init_instr k101_im2byl02_init[] = {
+	PANEL_INIT_SWITCH_PAGE_INSTR(3),
+	PANEL_INIT_COMMAND_INSTR(0x01, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x02, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x03, 0x73),
+	PANEL_INIT_COMMAND_INSTR(0x04, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x05, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x06, 0x08),
+	PANEL_INIT_COMMAND_INSTR(0x07, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x08, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x09, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0A, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x0B, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x0C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0D, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x0E, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x0F, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x10, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x11, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x12, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x13, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x14, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x15, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x16, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x17, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x18, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x19, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1D, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1E, 0x40),
+	PANEL_INIT_COMMAND_INSTR(0x1F, 0xC0),
+	PANEL_INIT_COMMAND_INSTR(0x20, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x21, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x23, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x24, 0x88),
+	PANEL_INIT_COMMAND_INSTR(0x25, 0x88),
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x27, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x28, 0x3B),
+	PANEL_INIT_COMMAND_INSTR(0x29, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x2A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2D, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2E, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2F, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x30, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x32, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x33, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x34, 0x00), /* GPWR1/2 non overlap time 2.62us */
+	PANEL_INIT_COMMAND_INSTR(0x35, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x36, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x37, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x38, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x39, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3D, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3E, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3F, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x40, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x41, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x42, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x43, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x44, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x50, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0x52, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x67),
+	PANEL_INIT_COMMAND_INSTR(0x54, 0x89),
+	PANEL_INIT_COMMAND_INSTR(0x55, 0xAB),
+	PANEL_INIT_COMMAND_INSTR(0x56, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x57, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0x58, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0x59, 0x67),
+	PANEL_INIT_COMMAND_INSTR(0x5A, 0x89),
+	PANEL_INIT_COMMAND_INSTR(0x5B, 0xAB),
+	PANEL_INIT_COMMAND_INSTR(0x5C, 0xCD),
+	PANEL_INIT_COMMAND_INSTR(0x5D, 0xEF),
+	PANEL_INIT_COMMAND_INSTR(0x5E, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x5F, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x61, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x62, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x63, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x64, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x65, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x66, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x67, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x68, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x69, 0x05),
+	PANEL_INIT_COMMAND_INSTR(0x6A, 0x05),
+	PANEL_INIT_COMMAND_INSTR(0x6B, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x6D, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x70, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x71, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x72, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x73, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x74, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x75, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x76, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x77, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x78, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x79, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x7A, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x7B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x7C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x7D, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7E, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7F, 0x05),
+	PANEL_INIT_COMMAND_INSTR(0x80, 0x05),
+	PANEL_INIT_COMMAND_INSTR(0x81, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x82, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x83, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x84, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x85, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x86, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x87, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x88, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x89, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x8A, 0x02),
+	PANEL_INIT_SWITCH_PAGE_INSTR(4),
+	PANEL_INIT_COMMAND_INSTR(0x3B, 0xC0), /* ILI4003D sel */
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x15), /* Set VCORE voltage = 1.5V */
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x2A), /* di_pwr_reg=0 for power mode 2A, VGH clamp 18V */
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x33), /* pumping ratio VGH=5x VGL=-3x */
+	PANEL_INIT_COMMAND_INSTR(0x8D, 0x1B), /* VGL clamp -10V */
+	PANEL_INIT_COMMAND_INSTR(0x87, 0xBA), /* ESD */
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0x24), /* POWER SAVING */
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x76),
+	PANEL_INIT_COMMAND_INSTR(0xB2, 0xD1),
+	PANEL_INIT_SWITCH_PAGE_INSTR(1),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x0A), /* BGR, SS */
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x00), /* Zigzag type3 inversion */
+	PANEL_INIT_COMMAND_INSTR(0x40, 0x53), /* ILI4003D sel */
+	PANEL_INIT_COMMAND_INSTR(0x43, 0x66),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x4C),
+	PANEL_INIT_COMMAND_INSTR(0x50, 0x87),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x82),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x15),
+	PANEL_INIT_COMMAND_INSTR(0x61, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x62, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x63, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0xA0, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0xA1, 0x13), /* VP251 */
+	PANEL_INIT_COMMAND_INSTR(0xA2, 0x23), /* VP247 */
+	PANEL_INIT_COMMAND_INSTR(0xA3, 0x14), /* VP243 */
+	PANEL_INIT_COMMAND_INSTR(0xA4, 0x16), /* VP239 */
+	PANEL_INIT_COMMAND_INSTR(0xA5, 0x29), /* VP231 */
+	PANEL_INIT_COMMAND_INSTR(0xA6, 0x1E), /* VP219 */
+	PANEL_INIT_COMMAND_INSTR(0xA7, 0x1D), /* VP203 */
+	PANEL_INIT_COMMAND_INSTR(0xA8, 0x86), /* VP175 */
+	PANEL_INIT_COMMAND_INSTR(0xA9, 0x1E), /* VP144 */
+	PANEL_INIT_COMMAND_INSTR(0xAA, 0x29), /* VP111 */
+	PANEL_INIT_COMMAND_INSTR(0xAB, 0x74), /* VP80 */
+	PANEL_INIT_COMMAND_INSTR(0xAC, 0x19), /* VP52 */
+	PANEL_INIT_COMMAND_INSTR(0xAD, 0x17), /* VP36 */
+	PANEL_INIT_COMMAND_INSTR(0xAE, 0x4B), /* VP24 */
+	PANEL_INIT_COMMAND_INSTR(0xAF, 0x20), /* VP16 */
+	PANEL_INIT_COMMAND_INSTR(0xB0, 0x26), /* VP12 */
+	PANEL_INIT_COMMAND_INSTR(0xB1, 0x4C), /* VP8 */
+	PANEL_INIT_COMMAND_INSTR(0xB2, 0x5D), /* VP4 */
+	PANEL_INIT_COMMAND_INSTR(0xB3, 0x3F), /* VP0 */
+	PANEL_INIT_COMMAND_INSTR(0xC0, 0x00), /* VN255 GAMMA N */
+	PANEL_INIT_COMMAND_INSTR(0xC1, 0x13), /* VN251 */
+	PANEL_INIT_COMMAND_INSTR(0xC2, 0x23), /* VN247 */
+	PANEL_INIT_COMMAND_INSTR(0xC3, 0x14), /* VN243 */
+	PANEL_INIT_COMMAND_INSTR(0xC4, 0x16), /* VN239 */
+	PANEL_INIT_COMMAND_INSTR(0xC5, 0x29), /* VN231 */
+	PANEL_INIT_COMMAND_INSTR(0xC6, 0x1E), /* VN219 */
+	PANEL_INIT_COMMAND_INSTR(0xC7, 0x1D), /* VN203 */
+	PANEL_INIT_COMMAND_INSTR(0xC8, 0x86), /* VN175 */
+	PANEL_INIT_COMMAND_INSTR(0xC9, 0x1E), /* VN144 */
+	PANEL_INIT_COMMAND_INSTR(0xCA, 0x29), /* VN111 */
+	PANEL_INIT_COMMAND_INSTR(0xCB, 0x74), /* VN80 */
+	PANEL_INIT_COMMAND_INSTR(0xCC, 0x19), /* VN52 */
+	PANEL_INIT_COMMAND_INSTR(0xCD, 0x17), /* VN36 */
+	PANEL_INIT_COMMAND_INSTR(0xCE, 0x4B), /* VN24 */
+	PANEL_INIT_COMMAND_INSTR(0xCF, 0x20), /* VN16 */
+	PANEL_INIT_COMMAND_INSTR(0xD0, 0x26), /* VN12 */
+	PANEL_INIT_COMMAND_INSTR(0xD1, 0x4C), /* VN8 */
+	PANEL_INIT_COMMAND_INSTR(0xD2, 0x5D), /* VN4 */
+	PANEL_INIT_COMMAND_INSTR(0xD3, 0x3F), /* VN0 */
 };
+#endif
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_NWE080)
+static const struct panel_init_instr nwe080_init[] = {
+	PANEL_INIT_SWITCH_PAGE_INSTR(3),
+	//GIP_1
+	PANEL_INIT_COMMAND_INSTR(0x01, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x02, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x03, 0x73),
+	PANEL_INIT_COMMAND_INSTR(0x04, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x05, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x06, 0x0A),
+	PANEL_INIT_COMMAND_INSTR(0x07, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x08, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x09, 0x20),
+	PANEL_INIT_COMMAND_INSTR(0x0a, 0x20),
+	PANEL_INIT_COMMAND_INSTR(0x0b, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0c, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0d, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0e, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x0f, 0x1E),
+	PANEL_INIT_COMMAND_INSTR(0x10, 0x1E),
+	PANEL_INIT_COMMAND_INSTR(0x11, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x12, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x13, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x14, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x15, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x16, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x17, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x18, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x19, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1D, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1E, 0x40),
+	PANEL_INIT_COMMAND_INSTR(0x1F, 0x80),
+	PANEL_INIT_COMMAND_INSTR(0x20, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x21, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x23, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x24, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x25, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x27, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x28, 0x33),
+	PANEL_INIT_COMMAND_INSTR(0x29, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x2A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2D, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2E, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x2F, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x30, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x32, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x33, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x34, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x35, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x36, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x37, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x38, 0x3C),
+	PANEL_INIT_COMMAND_INSTR(0x39, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3D, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3E, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x3F, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x40, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x41, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x42, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x43, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x44, 0x00),
+
+	PANEL_INIT_COMMAND_INSTR(0x50, 0x10),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x32),
+	PANEL_INIT_COMMAND_INSTR(0x52, 0x54),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x76),
+	PANEL_INIT_COMMAND_INSTR(0x54, 0x98),
+	PANEL_INIT_COMMAND_INSTR(0x55, 0xba),
+	PANEL_INIT_COMMAND_INSTR(0x56, 0x10),
+	PANEL_INIT_COMMAND_INSTR(0x57, 0x32),
+	PANEL_INIT_COMMAND_INSTR(0x58, 0x54),
+	PANEL_INIT_COMMAND_INSTR(0x59, 0x76),
+	PANEL_INIT_COMMAND_INSTR(0x5A, 0x98),
+	PANEL_INIT_COMMAND_INSTR(0x5B, 0xba),
+	PANEL_INIT_COMMAND_INSTR(0x5C, 0xdc),
+	PANEL_INIT_COMMAND_INSTR(0x5D, 0xfe),
+
+	//GIP_3
+	PANEL_INIT_COMMAND_INSTR(0x5E, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x5F, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x61, 0x15),
+	PANEL_INIT_COMMAND_INSTR(0x62, 0x14),
+	PANEL_INIT_COMMAND_INSTR(0x63, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x64, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x65, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x66, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x67, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x68, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x69, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6A, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6B, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6D, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x70, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x71, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x72, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x73, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x74, 0x02),
+
+	PANEL_INIT_COMMAND_INSTR(0x75, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x76, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x77, 0x14),
+	PANEL_INIT_COMMAND_INSTR(0x78, 0x15),
+	PANEL_INIT_COMMAND_INSTR(0x79, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x7A, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x7B, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x7C, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x7D, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x7E, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x7F, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x80, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x81, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x82, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x83, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x84, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x85, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x86, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x87, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x88, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x89, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x8A, 0x02),
+
+	PANEL_INIT_SWITCH_PAGE_INSTR(4),
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x15),
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x2A),
+
+	//clamp 15V
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x35),
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0x92),
+	PANEL_INIT_COMMAND_INSTR(0x8D, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x87, 0xBA),
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x76),
+	PANEL_INIT_COMMAND_INSTR(0xB2, 0xD1),
+	PANEL_INIT_COMMAND_INSTR(0xB5, 0x27),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x75),
+	PANEL_INIT_COMMAND_INSTR(0x30, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x3B, 0x98),
+	PANEL_INIT_COMMAND_INSTR(0x35, 0x17),
+	PANEL_INIT_COMMAND_INSTR(0x33, 0x14),
+	PANEL_INIT_COMMAND_INSTR(0x38, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x39, 0x00),
+
+	PANEL_INIT_SWITCH_PAGE_INSTR(1),
+	// direction rotate
+	//PANEL_INIT_COMMAND_INSTR(0x22, 0x0B),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x0A),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x63),
+	PANEL_INIT_COMMAND_INSTR(0x55, 0x69),
+	PANEL_INIT_COMMAND_INSTR(0x50, 0xC7),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0xC2),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x26),
+
+	PANEL_INIT_COMMAND_INSTR(0xA0, 0x08),
+	PANEL_INIT_COMMAND_INSTR(0xA1, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0xA2, 0x25),
+	PANEL_INIT_COMMAND_INSTR(0xA3, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0xA4, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0xA5, 0x18),
+	PANEL_INIT_COMMAND_INSTR(0xA6, 0x11),
+	PANEL_INIT_COMMAND_INSTR(0xA7, 0x1A),
+	PANEL_INIT_COMMAND_INSTR(0xA8, 0x81),
+	PANEL_INIT_COMMAND_INSTR(0xA9, 0x19),
+	PANEL_INIT_COMMAND_INSTR(0xAA, 0x26),
+	PANEL_INIT_COMMAND_INSTR(0xAB, 0x7C),
+	PANEL_INIT_COMMAND_INSTR(0xAC, 0x24),
+	PANEL_INIT_COMMAND_INSTR(0xAD, 0x1E),
+	PANEL_INIT_COMMAND_INSTR(0xAE, 0x5C),
+	PANEL_INIT_COMMAND_INSTR(0xAF, 0x2A),
+	PANEL_INIT_COMMAND_INSTR(0xB0, 0x2B),
+	PANEL_INIT_COMMAND_INSTR(0xB1, 0x50),
+	PANEL_INIT_COMMAND_INSTR(0xB2, 0x5C),
+	PANEL_INIT_COMMAND_INSTR(0xB3, 0x39),
+
+	PANEL_INIT_COMMAND_INSTR(0xC0, 0x08),
+	PANEL_INIT_COMMAND_INSTR(0xC1, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0xC2, 0x24),
+	PANEL_INIT_COMMAND_INSTR(0xC3, 0x1D),
+	PANEL_INIT_COMMAND_INSTR(0xC4, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0xC5, 0x32),
+	PANEL_INIT_COMMAND_INSTR(0xC6, 0x24),
+	PANEL_INIT_COMMAND_INSTR(0xC7, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0xC8, 0x90),
+	PANEL_INIT_COMMAND_INSTR(0xC9, 0x20),
+	PANEL_INIT_COMMAND_INSTR(0xCA, 0x2C),
+	PANEL_INIT_COMMAND_INSTR(0xCB, 0x82),
+	PANEL_INIT_COMMAND_INSTR(0xCC, 0x19),
+	PANEL_INIT_COMMAND_INSTR(0xCD, 0x22),
+	PANEL_INIT_COMMAND_INSTR(0xCE, 0x4E),
+	PANEL_INIT_COMMAND_INSTR(0xCF, 0x28),
+	PANEL_INIT_COMMAND_INSTR(0xD0, 0x2D),
+	PANEL_INIT_COMMAND_INSTR(0xD1, 0x51),
+	PANEL_INIT_COMMAND_INSTR(0xD2, 0x5D),
+	PANEL_INIT_COMMAND_INSTR(0xD3, 0x39),
+
+	PANEL_INIT_SWITCH_PAGE_INSTR(0),
+	//PWM
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x52, 0xFF),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x2C),
+};
+#endif
+
+static inline struct ili9881c *panel_to_ili9881c(struct drm_panel *panel)
+{
+	return container_of(panel, struct ili9881c, panel);
+}
+
+/*
+ * The panel seems to accept some private DCS commands that map
+ * directly to registers.
+ *
+ * It is organised by page, with each page having its own set of
+ * registers, and the first page looks like it's holding the standard
+ * DCS commands.
+ *
+ * So before any attempt at sending a command or data, we have to be
+ * sure if we're in the right page or not.
+ */
+static int __maybe_unused ili9881c_page_ili9881c(struct ili9881c *ctx, u8 page)
+{
+	u8 buf[4] = { 0xff, 0x98, 0x81, page };
+	int ret;
+
+	ret = panel_dsi_trace_dcs_write_buffer(&ctx->trace, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+
+	return 0;
+}
+
+static int __maybe_unused ili9881c_page_jd9366(struct ili9881c *ctx, u8 page)
+{
+	u8 buf[2] = { 0xe0, page };
+	int ret;
+
+	ret = panel_dsi_trace_dcs_write_buffer(&ctx->trace, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+
+	return 0;
+}
+
+static int ili9881c_dcs_write(struct ili9881c *ctx, u8 cmd,
+			      const void *data, size_t len)
+{
+	ssize_t ret;
+
+	ret = panel_dsi_trace_dcs_write(&ctx->trace, cmd, data, len);
+	if (ret < 0)
+		return ret;
+
+	return 0;
+}
+
+static int ili9881c_switch_page(struct ili9881c *ctx, u8 page)
+{
+	return ctx->desc->switch_page(ctx, page);
+}
+
+static int ili9881c_send_cmd_data(struct ili9881c *ctx, u8 cmd, u8 data)
+{
+	u8 buf[2] = { cmd, data };
+	int ret;
+
+	ret = panel_dsi_trace_dcs_write_buffer(&ctx->trace, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+
+	return 0;
+}
+
+/*
+ * Some init tables coming from vendors end with their own sleep out,
+ * display on and tear on commands, usually without the delays they
+ * need. The power state of the panel is handled by the driver alone,
+ * so these are never sent from the tables.
+ */
+static bool ili9881c_is_power_cmd(u8 cmd)
+{
+	switch (cmd) {
+	case MIPI_DCS_ENTER_SLEEP_MODE:
+	case MIPI_DCS_EXIT_SLEEP_MODE:
+	case MIPI_DCS_SET_DISPLAY_OFF:
+	case MIPI_DCS_SET_DISPLAY_ON:
+	case MIPI_DCS_SET_TEAR_OFF:
+	case MIPI_DCS_SET_TEAR_ON:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int ili9881c_send_segment(void *data,
+				 const struct panel_init_instr *instr,
+				 size_t length, u8 page)
+{
+	struct ili9881c *ctx = data;
+	unsigned int i;
+	int ret = 0;
+
+	/* Don't rely on the page left selected by whatever ran before */
+	if (instr->op != PANEL_INIT_SWITCH_PAGE) {
+		ret = ili9881c_switch_page(ctx, page);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < length; i++, instr++) {
+		if (instr->op == PANEL_INIT_SWITCH_PAGE) {
+			ret = ili9881c_switch_page(ctx, instr->arg.page);
+		} else if (instr->op == PANEL_INIT_COMMAND) {
+			if (!page && ili9881c_is_power_cmd(instr->arg.cmd.cmd))
+				continue;
+
+			ret = ili9881c_send_cmd_data(ctx, instr->arg.cmd.cmd,
+						      instr->arg.cmd.data);
+		}
+
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int ili9881c_exit_sleep(struct ili9881c *ctx)
+{
+	int ret;
+
+	ret = ili9881c_dcs_write(ctx, MIPI_DCS_EXIT_SLEEP_MODE, NULL, 0);
+	if (ret)
+		return ret;
+
+	ctx->sleep_out = ktime_get();
+
+	return 0;
+}
+
+/*
+ * The controller needs some time after sleep out before it can turn the
+ * display on. Only wait for what's left of it, since the DSI host
+ * usually has started sending video in the meantime.
+ */
+static int ili9881c_display_on(struct ili9881c *ctx)
+{
+	s64 elapsed = ktime_ms_delta(ktime_get(), ctx->sleep_out);
+
+	if (elapsed < ILI9881C_SLEEP_OUT_MS)
+		msleep(ILI9881C_SLEEP_OUT_MS - elapsed);
+
+	return ili9881c_dcs_write(ctx, MIPI_DCS_SET_DISPLAY_ON, NULL, 0);
+}
+
+/*
+ * See panel_init_send(). If page is not PANEL_INIT_ALL_PAGES, only the
+ * segments targeting that page are sent.
+ *
+ * The private pages only accept writes once the controller is unlocked.
+ * The JD9366 wants its E1-E3 password, sent in the page 0 segment at the
+ * head of its script, so that segment goes first when reloading a single
+ * page. The ILI9881C unlocks with every page switch, its scripts don't
+ * start on page 0.
+ */
+static int ili9881c_send_init(struct ili9881c *ctx, int page)
+{
+	const struct ili9881c_desc *desc = ctx->desc;
+	size_t head;
+	int ret;
+
+	if (page != PANEL_INIT_ALL_PAGES && page != 0) {
+		for (head = 1; head < desc->init_length; head++)
+			if (desc->init[head].op == PANEL_INIT_SWITCH_PAGE)
+				break;
+
+		ret = panel_init_send(desc->init, head, 0,
+				      ili9881c_send_segment, ctx,
+				      &ctx->init_retries);
+		if (ret) {
+			ctx->init_failures++;
+			return ret;
+		}
+	}
+
+	ret = panel_init_send(desc->init, desc->init_length, page,
+			      ili9881c_send_segment, ctx, &ctx->init_retries);
+	if (ret) {
+		ctx->init_failures++;
+		return ret;
+	}
+
+	return ili9881c_switch_page(ctx, 0);
+}
+
+/*
+ * Powering the panel up is done in two stages. ili9881c_reset() powers
+ * the panel and pulses its reset line, ili9881c_reset_settle() then
+ * waits for what's left of the settle time before the first command.
+ * Whatever happened in between, such as the DSI host bring-up when the
+ * early stage runs from ili9881c_power_work(), overlaps the wait.
+ */
+static int ili9881c_reset(struct ili9881c *ctx)
+{
+	int ret;
+
+	/* Power the panel */
+	ret = regulator_enable(ctx->power);
+	if (ret)
+		return ret;
+	msleep(ILI9881C_POWER_UP_MS);
+
+	/* And reset it */
+	gpiod_set_value(ctx->reset, 1);
+	msleep(ILI9881C_RESET_MS);
+
+	gpiod_set_value(ctx->reset, 0);
+	ctx->reset_released = ktime_get();
+
+	return 0;
+}
+
+static unsigned int ili9881c_settle_ms(const struct ili9881c_desc *desc)
+{
+	return desc->reset_settle_ms ?: ILI9881C_RESET_SETTLE_MS;
+}
+
+static void ili9881c_reset_settle(struct ili9881c *ctx, unsigned int settle_ms)
+{
+	s64 left = settle_ms - ktime_ms_delta(ktime_get(), ctx->reset_released);
+
+	if (left > 0)
+		msleep(left);
+}
+
+static int ili9881c_power_on(struct ili9881c *ctx)
+{
+	u8 tear_mode = MIPI_DSI_DCS_TEAR_MODE_VBLANK;
+	int ret;
+
+	/*
+	 * Identification or the early power up left the panel powered and
+	 * fresh out of reset.
+	 */
+	if (ctx->powered) {
+		ctx->powered = false;
+	} else {
+		ret = ili9881c_reset(ctx);
+		if (ret)
+			return ret;
+	}
+
+	ili9881c_reset_settle(ctx, ili9881c_settle_ms(ctx->desc));
+
+	ret = ili9881c_send_init(ctx, PANEL_INIT_ALL_PAGES);
+	if (ret)
+		goto err_power_off;
+
+	ret = ili9881c_dcs_write(ctx, MIPI_DCS_SET_TEAR_ON, &tear_mode, 1);
+	if (ret)
+		goto err_power_off;
+
+	ret = ili9881c_exit_sleep(ctx);
+	if (ret)
+		goto err_power_off;
+
+	return 0;
+
+err_power_off:
+	gpiod_set_value(ctx->reset, 1);
+	regulator_disable(ctx->power);
+	return ret;
+}
+
+static void ili9881c_power_off(struct ili9881c *ctx)
+{
+	ili9881c_dcs_write(ctx, MIPI_DCS_ENTER_SLEEP_MODE, NULL, 0);
+	regulator_disable(ctx->power);
+	gpiod_set_value(ctx->reset, 1);
+}
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_CUTIEPI)
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_NWE080)
+static const struct ili9881c_desc nwe080_desc;
+#endif
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_JD9366)
+static const struct ili9881c_desc jd9366_desc;
+#endif
+
+/*
+ * The CutiePi can be fitted with either an NWE080 or a BOE JD9366 panel.
+ * These IDs haven't been checked on every variant yet, the CutiePi
+ * overlay only uses the identification on request.
+ */
+static const struct ili9881c_id ili9881c_cutiepi_ids[] = {
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_NWE080)
+	{
+		.id	= { 0x98, 0x81, 0x0c },
+		.mask	= { 0xff, 0xff, 0x00 },
+		.desc	= &nwe080_desc,
+	},
+#endif
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_JD9366)
+	{
+		.id	= { 0x93, 0x66, 0x00 },
+		.mask	= { 0xff, 0xff, 0x00 },
+		.desc	= &jd9366_desc,
+	},
+#endif
+	{ /* sentinel */ }
+};
+
+/* Result of the identification, kept for the rest of the boot */
+static const struct ili9881c_desc *ili9881c_cached_desc;
+
+static bool ili9881c_id_match(const struct ili9881c_id *entry, const u8 *id)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(entry->id); i++)
+		if ((id[i] ^ entry->id[i]) & entry->mask[i])
+			return false;
+
+	return true;
+}
+
+/*
+ * Boards that can be fitted with several panels use a generic
+ * compatible. Probe reads the panel ID to find out which description to
+ * use before attaching to the DSI host, which latches the mode flags,
+ * and before DRM asks for the modes. The panel is left powered so that
+ * ili9881c_power_on() doesn't have to reset it again.
+ */
+static int ili9881c_identify(struct ili9881c *ctx)
+{
+	struct device *dev = &ctx->dsi->dev;
+	const struct ili9881c_id *entry;
+	unsigned int settle_ms = 0;
+	u8 id[3];
+	int ret;
+
+	if (ili9881c_cached_desc) {
+		ctx->desc = ili9881c_cached_desc;
+		return 0;
+	}
+
+	/* Whichever panel it is, it has to be out of reset */
+	for (entry = ili9881c_cutiepi_ids; entry->desc; entry++)
+		settle_ms = max(settle_ms, ili9881c_settle_ms(entry->desc));
+
+	ret = ili9881c_reset(ctx);
+	if (ret)
+		return ret;
+	ctx->powered = true;
+
+	ili9881c_reset_settle(ctx, settle_ms);
+
+	ret = panel_dsi_trace_dcs_read(&ctx->trace, 0xda, &id[0], 1);
+	if (ret == 1)
+		ret = panel_dsi_trace_dcs_read(&ctx->trace, 0xdb, &id[1], 1);
+	if (ret == 1)
+		ret = panel_dsi_trace_dcs_read(&ctx->trace, 0xdc, &id[2], 1);
+	if (ret != 1) {
+		ret = ret < 0 ? ret : -EIO;
+		goto err_power_off;
+	}
+
+	for (entry = ili9881c_cutiepi_ids; entry->desc; entry++) {
+		if (!ili9881c_id_match(entry, id))
+			continue;
+
+		ctx->desc = entry->desc;
+		ili9881c_cached_desc = entry->desc;
+
+		dev_info(dev, "Found panel with ID %02x %02x %02x\n",
+			 id[0], id[1], id[2]);
+		return 0;
+	}
+
+	dev_err(dev, "Unknown panel ID %02x %02x %02x\n", id[0], id[1], id[2]);
+	ret = -ENODEV;
+
+err_power_off:
+	gpiod_set_value(ctx->reset, 1);
+	regulator_disable(ctx->power);
+	ctx->powered = false;
+	return ret;
+}
+#else
+/* The generic compatible is only matched with the identification */
+static const struct ili9881c_id ili9881c_cutiepi_ids[] = {
+	{ /* sentinel */ }
+};
+
+static int ili9881c_identify(struct ili9881c *ctx)
+{
+	return -ENODEV;
+}
+#endif
+
+static const char * const ili9881c_state_names[ILI9881C_NUM_STATES] = {
+	[ILI9881C_STATE_OFF]		= "off",
+	[ILI9881C_STATE_POWERED]	= "powered",
+	[ILI9881C_STATE_PREPARED]	= "prepared",
+	[ILI9881C_STATE_ON]		= "on",
+	[ILI9881C_STATE_AMBIENT]	= "ambient",
+};
+
+static enum ili9881c_state ili9881c_state(struct ili9881c *ctx)
+{
+	if (ctx->ambient)
+		return ILI9881C_STATE_AMBIENT;
+	if (ctx->enabled)
+		return ILI9881C_STATE_ON;
+	if (ctx->prepared)
+		return ILI9881C_STATE_PREPARED;
+	if (ctx->powered)
+		return ILI9881C_STATE_POWERED;
+
+	return ILI9881C_STATE_OFF;
+}
+
+/*
+ * Charge the time since the last call to the previous panel state and
+ * backlight level, and pick up the new ones. Called with the lock held
+ * after every state change, and when the statistics are read.
+ *
+ * Nothing tells us when userspace changes the brightness: a new level
+ * is only seen on the next call, and the time in between is charged to
+ * the old one.
+ */
+static void ili9881c_account(struct ili9881c *ctx)
+{
+	struct ili9881c_residency *res = &ctx->res;
+	struct backlight_device *bl = ctx->panel.backlight;
+	enum ili9881c_state state = ili9881c_state(ctx);
+	ktime_t now = ktime_get();
+	u64 us = ktime_us_delta(now, res->since);
+	int brightness;
+
+	res->state_us[res->state] += us;
+	res->bl_us[res->bl_bucket] += us;
+
+	if (state != res->state)
+		res->transitions[state]++;
+
+	res->state = state;
+	res->since = now;
+
+	brightness = bl ? backlight_get_brightness(bl) : 0;
+	if (!brightness || !ctx->max_brightness)
+		res->bl_bucket = 0;
+	else
+		res->bl_bucket = 1 + min(brightness * 3 / ctx->max_brightness, 2);
+}
+
+#define ILI9881C_POWER_MODE_ON		(MIPI_DCS_POWER_MODE_DISPLAY |	\
+					 MIPI_DCS_POWER_MODE_NORMAL |	\
+					 MIPI_DCS_POWER_MODE_SLEEP)
+
+static int ili9881c_check_power_mode(struct ili9881c *ctx)
+{
+	u8 mode;
+	int ret;
+
+	ret = panel_dsi_trace_dcs_read(&ctx->trace, MIPI_DCS_GET_POWER_MODE,
+				       &mode, 1);
+	if (ret < 1)
+		return ret < 0 ? ret : -ENODATA;
+
+	if ((mode & ILI9881C_POWER_MODE_ON) != ILI9881C_POWER_MODE_ON)
+		return -EIO;
+
+	return 0;
+}
+
+/*
+ * Use the first register written to each private page as a signature
+ * for that page, and read it back. Page 0 holds the standard DCS
+ * registers, which are already covered by the power mode check.
+ *
+ * Returns 1 and the faulty page on a mismatch, 0 if everything matches,
+ * or a negative error code if the panel didn't answer.
+ */
+static int ili9881c_check_pages(struct ili9881c *ctx, u8 *bad_page)
+{
+	bool check = false;
+	unsigned int i;
+	u8 page = 0;
+	u8 val;
+	int ret = 0;
+
+	for (i = 0; i < ctx->desc->init_length; i++) {
+		const struct panel_init_instr *instr = &ctx->desc->init[i];
+
+		if (instr->op == PANEL_INIT_SWITCH_PAGE) {
+			page = instr->arg.page;
+			check = page != 0;
+			if (!check)
+				continue;
+
+			ret = ili9881c_switch_page(ctx, page);
+			if (ret)
+				goto out;
+
+			continue;
+		}
+
+		if (!check)
+			continue;
+		check = false;
+
+		ret = panel_dsi_trace_dcs_read(&ctx->trace, instr->arg.cmd.cmd, &val, 1);
+		if (ret < 1) {
+			ret = ret < 0 ? ret : -EIO;
+			goto out;
+		}
+
+		if (val != instr->arg.cmd.data) {
+			*bad_page = page;
+			ret = 1;
+			goto out;
+		}
+	}
+	ret = 0;
+
+out:
+	if (ili9881c_switch_page(ctx, 0) && !ret)
+		ret = -EIO;
+
+	return ret;
+}
+
+/*
+ * Recovery is attempted in three steps, from the cheapest to the most
+ * expensive one: sleep out and display on again, then reload the page
+ * that lost its content, and finally power cycle the whole panel.
+ */
+static void ili9881c_esd_check(struct ili9881c *ctx)
+{
+	struct device *dev = &ctx->dsi->dev;
+	u8 page;
+	int ret;
+
+	ctx->esd_checks++;
+
+	ret = ili9881c_check_power_mode(ctx);
+	if (ret) {
+		dev_warn(dev, "Panel left normal mode, waking it up\n");
+		ctx->esd_sleep_recoveries++;
+
+		ret = ili9881c_exit_sleep(ctx);
+		if (!ret)
+			ret = ili9881c_display_on(ctx);
+		if (!ret)
+			ret = ili9881c_check_power_mode(ctx);
+		if (ret)
+			goto reset;
+	}
+
+	ret = ili9881c_check_pages(ctx, &page);
+	if (ret > 0) {
+		dev_warn(dev, "Page %u lost its content, reloading it\n", page);
+		ctx->esd_page_recoveries++;
+
+		ret = ili9881c_send_init(ctx, page);
+		if (!ret)
+			ret = ili9881c_check_pages(ctx, &page);
+	}
+
+	if (!ret)
+		return;
+
+reset:
+	dev_warn(dev, "Soft recovery failed (%d), resetting the panel\n", ret);
+	ctx->esd_reset_recoveries++;
+
+	ili9881c_power_off(ctx);
+	ret = ili9881c_power_on(ctx);
+	if (!ret)
+		ret = ili9881c_display_on(ctx);
+	if (!ret && ctx->ambient)
+		ret = ili9881c_dcs_write(ctx, MIPI_DCS_ENTER_IDLE_MODE, NULL, 0);
+
+	if (ret) {
+		dev_err(dev, "Couldn't recover the panel: %d\n", ret);
+
+		/* ili9881c_power_on() already cut the power on failure */
+		ctx->prepared = false;
+		ctx->enabled = false;
+	}
+}
+
+static void ili9881c_esd_schedule(struct ili9881c *ctx)
+{
+	unsigned int period = READ_ONCE(esd_check_ms);
+
+	if (!period)
+		return;
+
+	queue_delayed_work(system_freezable_wq, &ctx->esd_work,
+			   round_jiffies_relative(msecs_to_jiffies(period)));
+}
+
+static void ili9881c_esd_work(struct work_struct *work)
+{
+	struct ili9881c *ctx = container_of(to_delayed_work(work),
+					    struct ili9881c, esd_work);
+
+	mutex_lock(&ctx->lock);
+
+	if (ctx->enabled) {
+		ili9881c_esd_check(ctx);
+		ili9881c_esd_schedule(ctx);
+	}
+
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+}
+
+/*
+ * Early stage of the power up, started when we know prepare() is about
+ * to be called: at the end of probe and on resume. There's no hook for
+ * the DSI host bring-up on this kernel, but this gets the regulator
+ * ramp, the reset pulse and most of the settle time out of the way by
+ * the time the host calls prepare(). If prepare() wins the race, this
+ * does nothing; if prepare() never comes, ili9881c_wake_timeout() cuts
+ * the power again.
+ */
+static void ili9881c_power_work(struct work_struct *work)
+{
+	struct ili9881c *ctx = container_of(work, struct ili9881c, power_work);
+
+	mutex_lock(&ctx->lock);
+
+	if (!ctx->prepared && !ctx->powered && !ili9881c_reset(ctx)) {
+		ctx->powered = true;
+		mod_delayed_work(system_wq, &ctx->wake_timeout,
+				 msecs_to_jiffies(ILI9881C_WAKE_TIMEOUT_MS));
+	}
+
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+}
+
+/*
+ * Cooling states, from the coolest to the hottest: each one lowers the
+ * backlight ceiling, and the hottest ones also make the low refresh mode
+ * the preferred one.
+ *
+ * The backlight device isn't ours, so the ceiling only holds for the
+ * levels the panel sets: the brightness is lowered to it on each state
+ * change and on enable(), userspace can still raise it in between.
+ */
+static const struct {
+	/* Percent of the maximum brightness */
+	unsigned int backlight;
+	bool low_refresh;
+} ili9881c_cooling_states[] = {
+	{ 100, false },
+	{  80, false },
+	{  60, false },
+	{  60, true },
+	{  40, true },
+};
+
+/* Both are called with the lock held */
+static int ili9881c_max_brightness(struct ili9881c *ctx)
+{
+	unsigned int level = ili9881c_cooling_states[ctx->cooling_state].backlight;
+
+	return DIV_ROUND_UP(ctx->max_brightness * level, 100);
+}
+
+static void ili9881c_apply_cooling(struct ili9881c *ctx)
+{
+	struct backlight_device *bl = ctx->panel.backlight;
+	int max = ili9881c_max_brightness(ctx);
+
+	if (bl && bl->props.brightness > max)
+		backlight_device_set_brightness(bl, max);
+}
+
+/*
+ * Ambient mode: the panel drops to 8 colors in DCS idle mode and the
+ * backlight is dimmed, which keeps a clock or a status screen visible
+ * for a fraction of the normal power. It's best combined with the low
+ * refresh mode exposed by ili9881c_get_modes().
+ *
+ * Both are called with the lock held.
+ */
+static int ili9881c_enter_ambient(struct ili9881c *ctx)
+{
+	struct backlight_device *bl = ctx->panel.backlight;
+	unsigned int level = min(READ_ONCE(ambient_brightness), 100U);
+	int ret;
+
+	if (ctx->ambient)
+		return 0;
+
+	if (!ctx->enabled)
+		return -EBUSY;
+
+	ret = ili9881c_dcs_write(ctx, MIPI_DCS_ENTER_IDLE_MODE, NULL, 0);
+	if (ret)
+		return ret;
+
+	if (bl) {
+		ctx->ambient_saved_brightness = bl->props.brightness;
+		backlight_device_set_brightness(bl,
+			min_t(int, DIV_ROUND_UP(ctx->max_brightness * level, 100),
+			      ili9881c_max_brightness(ctx)));
+	}
+
+	ctx->ambient = true;
+
+	return 0;
+}
+
+static int ili9881c_exit_ambient(struct ili9881c *ctx)
+{
+	struct backlight_device *bl = ctx->panel.backlight;
+	int ret;
+
+	if (!ctx->ambient)
+		return 0;
+
+	/* Back to full color before the backlight goes up */
+	ret = ili9881c_dcs_write(ctx, MIPI_DCS_EXIT_IDLE_MODE, NULL, 0);
+
+	/* The cooling device may have lowered the ceiling in the meantime */
+	if (bl)
+		backlight_device_set_brightness(bl,
+			min(ctx->ambient_saved_brightness,
+			    ili9881c_max_brightness(ctx)));
 
-struct ili9881c_instr {
-	enum ili9881c_op	op;
+	ctx->ambient = false;
 
-	union arg {
-		struct cmd {
-			u8	cmd;
-			u8	data;
-		} cmd;
-		u8	page;
-	} arg;
-};
+	return ret;
+}
 
-struct ili9881c_desc {
-	const struct ili9881c_instr *init;
-	const size_t init_length;
-	const struct drm_display_mode *mode;
-	const unsigned flags;
-};
+/*
+ * First touch while the panel is idle: leave the ambient mode, or if the
+ * panel is off, start the early power up while userspace gets around to
+ * enabling the display. The DSI host may well be off at that point, so
+ * this can't go any further than the reset; that is still the regulator
+ * ramp, the reset pulse and the settle time off prepare(). If nothing
+ * prepares the panel in time, the power is cut again.
+ */
+static void ili9881c_wake_work(struct work_struct *work)
+{
+	struct ili9881c *ctx = container_of(work, struct ili9881c,
+					    wake_work);
+
+	mutex_lock(&ctx->lock);
+
+	if (ctx->ambient) {
+		ili9881c_exit_ambient(ctx);
+	} else if (!ctx->prepared && !ctx->powered &&
+		   READ_ONCE(touch_wake) && !ili9881c_reset(ctx)) {
+		ctx->powered = true;
+		ctx->touch_wakes++;
+		mod_delayed_work(system_wq, &ctx->wake_timeout,
+				 msecs_to_jiffies(ILI9881C_WAKE_TIMEOUT_MS));
+	}
 
-struct ili9881c {
-	struct drm_panel	panel;
-	struct mipi_dsi_device	*dsi;
-	const struct ili9881c_desc	*desc;
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+}
 
-	struct regulator	*power;
-	struct gpio_desc	*reset;
-};
+static void ili9881c_wake_timeout(struct work_struct *work)
+{
+	struct ili9881c *ctx = container_of(to_delayed_work(work),
+					    struct ili9881c, wake_timeout);
 
-#define ILI9881C_SWITCH_PAGE_INSTR(_page)	\
-	{					\
-		.op = ILI9881C_SWITCH_PAGE,	\
-		.arg = {			\
-			.page = (_page),	\
-		},				\
-	}
+	mutex_lock(&ctx->lock);
 
-#define ILI9881C_COMMAND_INSTR(_cmd, _data)		\
-	{						\
-		.op = ILI9881C_COMMAND,		\
-		.arg = {				\
-			.cmd = {			\
-				.cmd = (_cmd),		\
-				.data = (_data),	\
-			},				\
-		},					\
+	if (ctx->powered && !ctx->prepared) {
+		gpiod_set_value(ctx->reset, 1);
+		regulator_disable(ctx->power);
+		ctx->powered = false;
 	}
 
-static const struct ili9881c_instr lhr050h41_init[] = {
-	ILI9881C_SWITCH_PAGE_INSTR(3),
-	ILI9881C_COMMAND_INSTR(0x01, 0x00),
-	ILI9881C_COMMAND_INSTR(0x02, 0x00),
-	ILI9881C_COMMAND_INSTR(0x03, 0x73),
-	ILI9881C_COMMAND_INSTR(0x04, 0x03),
-	ILI9881C_COMMAND_INSTR(0x05, 0x00),
-	ILI9881C_COMMAND_INSTR(0x06, 0x06),
-	ILI9881C_COMMAND_INSTR(0x07, 0x06),
-	ILI9881C_COMMAND_INSTR(0x08, 0x00),
-	ILI9881C_COMMAND_INSTR(0x09, 0x18),
-	ILI9881C_COMMAND_INSTR(0x0a, 0x04),
-	ILI9881C_COMMAND_INSTR(0x0b, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0c, 0x02),
-	ILI9881C_COMMAND_INSTR(0x0d, 0x03),
-	ILI9881C_COMMAND_INSTR(0x0e, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0f, 0x25),
-	ILI9881C_COMMAND_INSTR(0x10, 0x25),
-	ILI9881C_COMMAND_INSTR(0x11, 0x00),
-	ILI9881C_COMMAND_INSTR(0x12, 0x00),
-	ILI9881C_COMMAND_INSTR(0x13, 0x00),
-	ILI9881C_COMMAND_INSTR(0x14, 0x00),
-	ILI9881C_COMMAND_INSTR(0x15, 0x00),
-	ILI9881C_COMMAND_INSTR(0x16, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x17, 0x00),
-	ILI9881C_COMMAND_INSTR(0x18, 0x00),
-	ILI9881C_COMMAND_INSTR(0x19, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1a, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1b, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1c, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1d, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1e, 0xC0),
-	ILI9881C_COMMAND_INSTR(0x1f, 0x80),
-	ILI9881C_COMMAND_INSTR(0x20, 0x04),
-	ILI9881C_COMMAND_INSTR(0x21, 0x01),
-	ILI9881C_COMMAND_INSTR(0x22, 0x00),
-	ILI9881C_COMMAND_INSTR(0x23, 0x00),
-	ILI9881C_COMMAND_INSTR(0x24, 0x00),
-	ILI9881C_COMMAND_INSTR(0x25, 0x00),
-	ILI9881C_COMMAND_INSTR(0x26, 0x00),
-	ILI9881C_COMMAND_INSTR(0x27, 0x00),
-	ILI9881C_COMMAND_INSTR(0x28, 0x33),
-	ILI9881C_COMMAND_INSTR(0x29, 0x03),
-	ILI9881C_COMMAND_INSTR(0x2a, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2b, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2c, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2d, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2e, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2f, 0x00),
-	ILI9881C_COMMAND_INSTR(0x30, 0x00),
-	ILI9881C_COMMAND_INSTR(0x31, 0x00),
-	ILI9881C_COMMAND_INSTR(0x32, 0x00),
-	ILI9881C_COMMAND_INSTR(0x33, 0x00),
-	ILI9881C_COMMAND_INSTR(0x34, 0x04),
-	ILI9881C_COMMAND_INSTR(0x35, 0x00),
-	ILI9881C_COMMAND_INSTR(0x36, 0x00),
-	ILI9881C_COMMAND_INSTR(0x37, 0x00),
-	ILI9881C_COMMAND_INSTR(0x38, 0x3C),
-	ILI9881C_COMMAND_INSTR(0x39, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3a, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3b, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3c, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3d, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3e, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3f, 0x00),
-	ILI9881C_COMMAND_INSTR(0x40, 0x00),
-	ILI9881C_COMMAND_INSTR(0x41, 0x00),
-	ILI9881C_COMMAND_INSTR(0x42, 0x00),
-	ILI9881C_COMMAND_INSTR(0x43, 0x00),
-	ILI9881C_COMMAND_INSTR(0x44, 0x00),
-	ILI9881C_COMMAND_INSTR(0x50, 0x01),
-	ILI9881C_COMMAND_INSTR(0x51, 0x23),
-	ILI9881C_COMMAND_INSTR(0x52, 0x45),
-	ILI9881C_COMMAND_INSTR(0x53, 0x67),
-	ILI9881C_COMMAND_INSTR(0x54, 0x89),
-	ILI9881C_COMMAND_INSTR(0x55, 0xab),
-	ILI9881C_COMMAND_INSTR(0x56, 0x01),
-	ILI9881C_COMMAND_INSTR(0x57, 0x23),
-	ILI9881C_COMMAND_INSTR(0x58, 0x45),
-	ILI9881C_COMMAND_INSTR(0x59, 0x67),
-	ILI9881C_COMMAND_INSTR(0x5a, 0x89),
-	ILI9881C_COMMAND_INSTR(0x5b, 0xab),
-	ILI9881C_COMMAND_INSTR(0x5c, 0xcd),
-	ILI9881C_COMMAND_INSTR(0x5d, 0xef),
-	ILI9881C_COMMAND_INSTR(0x5e, 0x11),
-	ILI9881C_COMMAND_INSTR(0x5f, 0x02),
-	ILI9881C_COMMAND_INSTR(0x60, 0x02),
-	ILI9881C_COMMAND_INSTR(0x61, 0x02),
-	ILI9881C_COMMAND_INSTR(0x62, 0x02),
-	ILI9881C_COMMAND_INSTR(0x63, 0x02),
-	ILI9881C_COMMAND_INSTR(0x64, 0x02),
-	ILI9881C_COMMAND_INSTR(0x65, 0x02),
-	ILI9881C_COMMAND_INSTR(0x66, 0x02),
-	ILI9881C_COMMAND_INSTR(0x67, 0x02),
-	ILI9881C_COMMAND_INSTR(0x68, 0x02),
-	ILI9881C_COMMAND_INSTR(0x69, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6a, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x6b, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6c, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x6d, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x6e, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x6f, 0x06),
-	ILI9881C_COMMAND_INSTR(0x70, 0x07),
-	ILI9881C_COMMAND_INSTR(0x71, 0x02),
-	ILI9881C_COMMAND_INSTR(0x72, 0x02),
-	ILI9881C_COMMAND_INSTR(0x73, 0x02),
-	ILI9881C_COMMAND_INSTR(0x74, 0x02),
-	ILI9881C_COMMAND_INSTR(0x75, 0x02),
-	ILI9881C_COMMAND_INSTR(0x76, 0x02),
-	ILI9881C_COMMAND_INSTR(0x77, 0x02),
-	ILI9881C_COMMAND_INSTR(0x78, 0x02),
-	ILI9881C_COMMAND_INSTR(0x79, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7a, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7b, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7c, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7d, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7e, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7f, 0x02),
-	ILI9881C_COMMAND_INSTR(0x80, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x81, 0x02),
-	ILI9881C_COMMAND_INSTR(0x82, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x83, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x84, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x85, 0x06),
-	ILI9881C_COMMAND_INSTR(0x86, 0x07),
-	ILI9881C_COMMAND_INSTR(0x87, 0x02),
-	ILI9881C_COMMAND_INSTR(0x88, 0x02),
-	ILI9881C_COMMAND_INSTR(0x89, 0x02),
-	ILI9881C_COMMAND_INSTR(0x8A, 0x02),
-	ILI9881C_SWITCH_PAGE_INSTR(4),
-	ILI9881C_COMMAND_INSTR(0x6C, 0x15),
-	ILI9881C_COMMAND_INSTR(0x6E, 0x22),
-	ILI9881C_COMMAND_INSTR(0x6F, 0x33),
-	ILI9881C_COMMAND_INSTR(0x3A, 0xA4),
-	ILI9881C_COMMAND_INSTR(0x8D, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x87, 0xBA),
-	ILI9881C_COMMAND_INSTR(0x26, 0x76),
-	ILI9881C_COMMAND_INSTR(0xB2, 0xD1),
-	ILI9881C_SWITCH_PAGE_INSTR(1),
-	ILI9881C_COMMAND_INSTR(0x22, 0x0A),
-	ILI9881C_COMMAND_INSTR(0x53, 0xDC),
-	ILI9881C_COMMAND_INSTR(0x55, 0xA7),
-	ILI9881C_COMMAND_INSTR(0x50, 0x78),
-	ILI9881C_COMMAND_INSTR(0x51, 0x78),
-	ILI9881C_COMMAND_INSTR(0x31, 0x02),
-	ILI9881C_COMMAND_INSTR(0x60, 0x14),
-	ILI9881C_COMMAND_INSTR(0xA0, 0x2A),
-	ILI9881C_COMMAND_INSTR(0xA1, 0x39),
-	ILI9881C_COMMAND_INSTR(0xA2, 0x46),
-	ILI9881C_COMMAND_INSTR(0xA3, 0x0e),
-	ILI9881C_COMMAND_INSTR(0xA4, 0x12),
-	ILI9881C_COMMAND_INSTR(0xA5, 0x25),
-	ILI9881C_COMMAND_INSTR(0xA6, 0x19),
-	ILI9881C_COMMAND_INSTR(0xA7, 0x1d),
-	ILI9881C_COMMAND_INSTR(0xA8, 0xa6),
-	ILI9881C_COMMAND_INSTR(0xA9, 0x1C),
-	ILI9881C_COMMAND_INSTR(0xAA, 0x29),
-	ILI9881C_COMMAND_INSTR(0xAB, 0x85),
-	ILI9881C_COMMAND_INSTR(0xAC, 0x1C),
-	ILI9881C_COMMAND_INSTR(0xAD, 0x1B),
-	ILI9881C_COMMAND_INSTR(0xAE, 0x51),
-	ILI9881C_COMMAND_INSTR(0xAF, 0x22),
-	ILI9881C_COMMAND_INSTR(0xB0, 0x2d),
-	ILI9881C_COMMAND_INSTR(0xB1, 0x4f),
-	ILI9881C_COMMAND_INSTR(0xB2, 0x59),
-	ILI9881C_COMMAND_INSTR(0xB3, 0x3F),
-	ILI9881C_COMMAND_INSTR(0xC0, 0x2A),
-	ILI9881C_COMMAND_INSTR(0xC1, 0x3a),
-	ILI9881C_COMMAND_INSTR(0xC2, 0x45),
-	ILI9881C_COMMAND_INSTR(0xC3, 0x0e),
-	ILI9881C_COMMAND_INSTR(0xC4, 0x11),
-	ILI9881C_COMMAND_INSTR(0xC5, 0x24),
-	ILI9881C_COMMAND_INSTR(0xC6, 0x1a),
-	ILI9881C_COMMAND_INSTR(0xC7, 0x1c),
-	ILI9881C_COMMAND_INSTR(0xC8, 0xaa),
-	ILI9881C_COMMAND_INSTR(0xC9, 0x1C),
-	ILI9881C_COMMAND_INSTR(0xCA, 0x29),
-	ILI9881C_COMMAND_INSTR(0xCB, 0x96),
-	ILI9881C_COMMAND_INSTR(0xCC, 0x1C),
-	ILI9881C_COMMAND_INSTR(0xCD, 0x1B),
-	ILI9881C_COMMAND_INSTR(0xCE, 0x51),
-	ILI9881C_COMMAND_INSTR(0xCF, 0x22),
-	ILI9881C_COMMAND_INSTR(0xD0, 0x2b),
-	ILI9881C_COMMAND_INSTR(0xD1, 0x4b),
-	ILI9881C_COMMAND_INSTR(0xD2, 0x59),
-	ILI9881C_COMMAND_INSTR(0xD3, 0x3F),
-};
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+}
 
-static const struct ili9881c_instr k101_im2byl02_init[] = {
-	ILI9881C_SWITCH_PAGE_INSTR(3),
-	ILI9881C_COMMAND_INSTR(0x01, 0x00),
-	ILI9881C_COMMAND_INSTR(0x02, 0x00),
-	ILI9881C_COMMAND_INSTR(0x03, 0x73),
-	ILI9881C_COMMAND_INSTR(0x04, 0x00),
-	ILI9881C_COMMAND_INSTR(0x05, 0x00),
-	ILI9881C_COMMAND_INSTR(0x06, 0x08),
-	ILI9881C_COMMAND_INSTR(0x07, 0x00),
-	ILI9881C_COMMAND_INSTR(0x08, 0x00),
-	ILI9881C_COMMAND_INSTR(0x09, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0A, 0x01),
-	ILI9881C_COMMAND_INSTR(0x0B, 0x01),
-	ILI9881C_COMMAND_INSTR(0x0C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0D, 0x01),
-	ILI9881C_COMMAND_INSTR(0x0E, 0x01),
-	ILI9881C_COMMAND_INSTR(0x0F, 0x00),
-	ILI9881C_COMMAND_INSTR(0x10, 0x00),
-	ILI9881C_COMMAND_INSTR(0x11, 0x00),
-	ILI9881C_COMMAND_INSTR(0x12, 0x00),
-	ILI9881C_COMMAND_INSTR(0x13, 0x00),
-	ILI9881C_COMMAND_INSTR(0x14, 0x00),
-	ILI9881C_COMMAND_INSTR(0x15, 0x00),
-	ILI9881C_COMMAND_INSTR(0x16, 0x00),
-	ILI9881C_COMMAND_INSTR(0x17, 0x00),
-	ILI9881C_COMMAND_INSTR(0x18, 0x00),
-	ILI9881C_COMMAND_INSTR(0x19, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1A, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1D, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1E, 0x40),
-	ILI9881C_COMMAND_INSTR(0x1F, 0xC0),
-	ILI9881C_COMMAND_INSTR(0x20, 0x06),
-	ILI9881C_COMMAND_INSTR(0x21, 0x01),
-	ILI9881C_COMMAND_INSTR(0x22, 0x06),
-	ILI9881C_COMMAND_INSTR(0x23, 0x01),
-	ILI9881C_COMMAND_INSTR(0x24, 0x88),
-	ILI9881C_COMMAND_INSTR(0x25, 0x88),
-	ILI9881C_COMMAND_INSTR(0x26, 0x00),
-	ILI9881C_COMMAND_INSTR(0x27, 0x00),
-	ILI9881C_COMMAND_INSTR(0x28, 0x3B),
-	ILI9881C_COMMAND_INSTR(0x29, 0x03),
-	ILI9881C_COMMAND_INSTR(0x2A, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2D, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2E, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2F, 0x00),
-	ILI9881C_COMMAND_INSTR(0x30, 0x00),
-	ILI9881C_COMMAND_INSTR(0x31, 0x00),
-	ILI9881C_COMMAND_INSTR(0x32, 0x00),
-	ILI9881C_COMMAND_INSTR(0x33, 0x00),
-	ILI9881C_COMMAND_INSTR(0x34, 0x00), /* GPWR1/2 non overlap time 2.62us */
-	ILI9881C_COMMAND_INSTR(0x35, 0x00),
-	ILI9881C_COMMAND_INSTR(0x36, 0x00),
-	ILI9881C_COMMAND_INSTR(0x37, 0x00),
-	ILI9881C_COMMAND_INSTR(0x38, 0x00),
-	ILI9881C_COMMAND_INSTR(0x39, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3A, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3D, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3E, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3F, 0x00),
-	ILI9881C_COMMAND_INSTR(0x40, 0x00),
-	ILI9881C_COMMAND_INSTR(0x41, 0x00),
-	ILI9881C_COMMAND_INSTR(0x42, 0x00),
-	ILI9881C_COMMAND_INSTR(0x43, 0x00),
-	ILI9881C_COMMAND_INSTR(0x44, 0x00),
-	ILI9881C_COMMAND_INSTR(0x50, 0x01),
-	ILI9881C_COMMAND_INSTR(0x51, 0x23),
-	ILI9881C_COMMAND_INSTR(0x52, 0x45),
-	ILI9881C_COMMAND_INSTR(0x53, 0x67),
-	ILI9881C_COMMAND_INSTR(0x54, 0x89),
-	ILI9881C_COMMAND_INSTR(0x55, 0xAB),
-	ILI9881C_COMMAND_INSTR(0x56, 0x01),
-	ILI9881C_COMMAND_INSTR(0x57, 0x23),
-	ILI9881C_COMMAND_INSTR(0x58, 0x45),
-	ILI9881C_COMMAND_INSTR(0x59, 0x67),
-	ILI9881C_COMMAND_INSTR(0x5A, 0x89),
-	ILI9881C_COMMAND_INSTR(0x5B, 0xAB),
-	ILI9881C_COMMAND_INSTR(0x5C, 0xCD),
-	ILI9881C_COMMAND_INSTR(0x5D, 0xEF),
-	ILI9881C_COMMAND_INSTR(0x5E, 0x00),
-	ILI9881C_COMMAND_INSTR(0x5F, 0x01),
-	ILI9881C_COMMAND_INSTR(0x60, 0x01),
-	ILI9881C_COMMAND_INSTR(0x61, 0x06),
-	ILI9881C_COMMAND_INSTR(0x62, 0x06),
-	ILI9881C_COMMAND_INSTR(0x63, 0x07),
-	ILI9881C_COMMAND_INSTR(0x64, 0x07),
-	ILI9881C_COMMAND_INSTR(0x65, 0x00),
-	ILI9881C_COMMAND_INSTR(0x66, 0x00),
-	ILI9881C_COMMAND_INSTR(0x67, 0x02),
-	ILI9881C_COMMAND_INSTR(0x68, 0x02),
-	ILI9881C_COMMAND_INSTR(0x69, 0x05),
-	ILI9881C_COMMAND_INSTR(0x6A, 0x05),
-	ILI9881C_COMMAND_INSTR(0x6B, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6C, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x6D, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x6E, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x6F, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x70, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x71, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x72, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x73, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x74, 0x02),
-	ILI9881C_COMMAND_INSTR(0x75, 0x01),
-	ILI9881C_COMMAND_INSTR(0x76, 0x01),
-	ILI9881C_COMMAND_INSTR(0x77, 0x06),
-	ILI9881C_COMMAND_INSTR(0x78, 0x06),
-	ILI9881C_COMMAND_INSTR(0x79, 0x07),
-	ILI9881C_COMMAND_INSTR(0x7A, 0x07),
-	ILI9881C_COMMAND_INSTR(0x7B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x7C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x7D, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7E, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7F, 0x05),
-	ILI9881C_COMMAND_INSTR(0x80, 0x05),
-	ILI9881C_COMMAND_INSTR(0x81, 0x02),
-	ILI9881C_COMMAND_INSTR(0x82, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x83, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x84, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x85, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x86, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x87, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x88, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x89, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x8A, 0x02),
-	ILI9881C_SWITCH_PAGE_INSTR(4),
-	ILI9881C_COMMAND_INSTR(0x3B, 0xC0), /* ILI4003D sel */
-	ILI9881C_COMMAND_INSTR(0x6C, 0x15), /* Set VCORE voltage = 1.5V */
-	ILI9881C_COMMAND_INSTR(0x6E, 0x2A), /* di_pwr_reg=0 for power mode 2A, VGH clamp 18V */
-	ILI9881C_COMMAND_INSTR(0x6F, 0x33), /* pumping ratio VGH=5x VGL=-3x */
-	ILI9881C_COMMAND_INSTR(0x8D, 0x1B), /* VGL clamp -10V */
-	ILI9881C_COMMAND_INSTR(0x87, 0xBA), /* ESD */
-	ILI9881C_COMMAND_INSTR(0x3A, 0x24), /* POWER SAVING */
-	ILI9881C_COMMAND_INSTR(0x26, 0x76),
-	ILI9881C_COMMAND_INSTR(0xB2, 0xD1),
-	ILI9881C_SWITCH_PAGE_INSTR(1),
-	ILI9881C_COMMAND_INSTR(0x22, 0x0A), /* BGR, SS */
-	ILI9881C_COMMAND_INSTR(0x31, 0x00), /* Zigzag type3 inversion */
-	ILI9881C_COMMAND_INSTR(0x40, 0x53), /* ILI4003D sel */
-	ILI9881C_COMMAND_INSTR(0x43, 0x66),
-	ILI9881C_COMMAND_INSTR(0x53, 0x4C),
-	ILI9881C_COMMAND_INSTR(0x50, 0x87),
-	ILI9881C_COMMAND_INSTR(0x51, 0x82),
-	ILI9881C_COMMAND_INSTR(0x60, 0x15),
-	ILI9881C_COMMAND_INSTR(0x61, 0x01),
-	ILI9881C_COMMAND_INSTR(0x62, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x63, 0x00),
-	ILI9881C_COMMAND_INSTR(0xA0, 0x00),
-	ILI9881C_COMMAND_INSTR(0xA1, 0x13), /* VP251 */
-	ILI9881C_COMMAND_INSTR(0xA2, 0x23), /* VP247 */
-	ILI9881C_COMMAND_INSTR(0xA3, 0x14), /* VP243 */
-	ILI9881C_COMMAND_INSTR(0xA4, 0x16), /* VP239 */
-	ILI9881C_COMMAND_INSTR(0xA5, 0x29), /* VP231 */
-	ILI9881C_COMMAND_INSTR(0xA6, 0x1E), /* VP219 */
-	ILI9881C_COMMAND_INSTR(0xA7, 0x1D), /* VP203 */
-	ILI9881C_COMMAND_INSTR(0xA8, 0x86), /* VP175 */
-	ILI9881C_COMMAND_INSTR(0xA9, 0x1E), /* VP144 */
-	ILI9881C_COMMAND_INSTR(0xAA, 0x29), /* VP111 */
-	ILI9881C_COMMAND_INSTR(0xAB, 0x74), /* VP80 */
-	ILI9881C_COMMAND_INSTR(0xAC, 0x19), /* VP52 */
-	ILI9881C_COMMAND_INSTR(0xAD, 0x17), /* VP36 */
-	ILI9881C_COMMAND_INSTR(0xAE, 0x4B), /* VP24 */
-	ILI9881C_COMMAND_INSTR(0xAF, 0x20), /* VP16 */
-	ILI9881C_COMMAND_INSTR(0xB0, 0x26), /* VP12 */
-	ILI9881C_COMMAND_INSTR(0xB1, 0x4C), /* VP8 */
-	ILI9881C_COMMAND_INSTR(0xB2, 0x5D), /* VP4 */
-	ILI9881C_COMMAND_INSTR(0xB3, 0x3F), /* VP0 */
-	ILI9881C_COMMAND_INSTR(0xC0, 0x00), /* VN255 GAMMA N */
-	ILI9881C_COMMAND_INSTR(0xC1, 0x13), /* VN251 */
-	ILI9881C_COMMAND_INSTR(0xC2, 0x23), /* VN247 */
-	ILI9881C_COMMAND_INSTR(0xC3, 0x14), /* VN243 */
-	ILI9881C_COMMAND_INSTR(0xC4, 0x16), /* VN239 */
-	ILI9881C_COMMAND_INSTR(0xC5, 0x29), /* VN231 */
-	ILI9881C_COMMAND_INSTR(0xC6, 0x1E), /* VN219 */
-	ILI9881C_COMMAND_INSTR(0xC7, 0x1D), /* VN203 */
-	ILI9881C_COMMAND_INSTR(0xC8, 0x86), /* VN175 */
-	ILI9881C_COMMAND_INSTR(0xC9, 0x1E), /* VN144 */
-	ILI9881C_COMMAND_INSTR(0xCA, 0x29), /* VN111 */
-	ILI9881C_COMMAND_INSTR(0xCB, 0x74), /* VN80 */
-	ILI9881C_COMMAND_INSTR(0xCC, 0x19), /* VN52 */
-	ILI9881C_COMMAND_INSTR(0xCD, 0x17), /* VN36 */
-	ILI9881C_COMMAND_INSTR(0xCE, 0x4B), /* VN24 */
-	ILI9881C_COMMAND_INSTR(0xCF, 0x20), /* VN16 */
-	ILI9881C_COMMAND_INSTR(0xD0, 0x26), /* VN12 */
-	ILI9881C_COMMAND_INSTR(0xD1, 0x4C), /* VN8 */
-	ILI9881C_COMMAND_INSTR(0xD2, 0x5D), /* VN4 */
-	ILI9881C_COMMAND_INSTR(0xD3, 0x3F), /* VN0 */
-};
+static int ili9881c_cooling_get_max_state(struct thermal_cooling_device *cdev,
+					  unsigned long *state)
+{
+	*state = ARRAY_SIZE(ili9881c_cooling_states) - 1;
 
-static const struct ili9881c_instr nwe080_init[] = {
-	ILI9881C_SWITCH_PAGE_INSTR(3),
-	//GIP_1
-	ILI9881C_COMMAND_INSTR(0x01, 0x00),
-	ILI9881C_COMMAND_INSTR(0x02, 0x00),
-	ILI9881C_COMMAND_INSTR(0x03, 0x73),
-	ILI9881C_COMMAND_INSTR(0x04, 0x00),
-	ILI9881C_COMMAND_INSTR(0x05, 0x00),
-	ILI9881C_COMMAND_INSTR(0x06, 0x0A),
-	ILI9881C_COMMAND_INSTR(0x07, 0x00),
-	ILI9881C_COMMAND_INSTR(0x08, 0x00),
-	ILI9881C_COMMAND_INSTR(0x09, 0x20),
-	ILI9881C_COMMAND_INSTR(0x0a, 0x20),
-	ILI9881C_COMMAND_INSTR(0x0b, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0c, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0d, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0e, 0x00),
-	ILI9881C_COMMAND_INSTR(0x0f, 0x1E),
-	ILI9881C_COMMAND_INSTR(0x10, 0x1E),
-	ILI9881C_COMMAND_INSTR(0x11, 0x00),
-	ILI9881C_COMMAND_INSTR(0x12, 0x00),
-	ILI9881C_COMMAND_INSTR(0x13, 0x00),
-	ILI9881C_COMMAND_INSTR(0x14, 0x00),
-	ILI9881C_COMMAND_INSTR(0x15, 0x00),
-	ILI9881C_COMMAND_INSTR(0x16, 0x00),
-	ILI9881C_COMMAND_INSTR(0x17, 0x00),
-	ILI9881C_COMMAND_INSTR(0x18, 0x00),
-	ILI9881C_COMMAND_INSTR(0x19, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1A, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1D, 0x00),
-	ILI9881C_COMMAND_INSTR(0x1E, 0x40),
-	ILI9881C_COMMAND_INSTR(0x1F, 0x80),
-	ILI9881C_COMMAND_INSTR(0x20, 0x06),
-	ILI9881C_COMMAND_INSTR(0x21, 0x01),
-	ILI9881C_COMMAND_INSTR(0x22, 0x00),
-	ILI9881C_COMMAND_INSTR(0x23, 0x00),
-	ILI9881C_COMMAND_INSTR(0x24, 0x00),
-	ILI9881C_COMMAND_INSTR(0x25, 0x00),
-	ILI9881C_COMMAND_INSTR(0x26, 0x00),
-	ILI9881C_COMMAND_INSTR(0x27, 0x00),
-	ILI9881C_COMMAND_INSTR(0x28, 0x33),
-	ILI9881C_COMMAND_INSTR(0x29, 0x03),
-	ILI9881C_COMMAND_INSTR(0x2A, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2D, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2E, 0x00),
-	ILI9881C_COMMAND_INSTR(0x2F, 0x00),
-	ILI9881C_COMMAND_INSTR(0x30, 0x00),
-	ILI9881C_COMMAND_INSTR(0x31, 0x00),
-	ILI9881C_COMMAND_INSTR(0x32, 0x00),
-	ILI9881C_COMMAND_INSTR(0x33, 0x00),
-	ILI9881C_COMMAND_INSTR(0x34, 0x04),
-	ILI9881C_COMMAND_INSTR(0x35, 0x00),
-	ILI9881C_COMMAND_INSTR(0x36, 0x00),
-	ILI9881C_COMMAND_INSTR(0x37, 0x00),
-	ILI9881C_COMMAND_INSTR(0x38, 0x3C),
-	ILI9881C_COMMAND_INSTR(0x39, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3A, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3B, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3C, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3D, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3E, 0x00),
-	ILI9881C_COMMAND_INSTR(0x3F, 0x00),
-	ILI9881C_COMMAND_INSTR(0x40, 0x00),
-	ILI9881C_COMMAND_INSTR(0x41, 0x00),
-	ILI9881C_COMMAND_INSTR(0x42, 0x00),
-	ILI9881C_COMMAND_INSTR(0x43, 0x00),
-	ILI9881C_COMMAND_INSTR(0x44, 0x00),
-
-	ILI9881C_COMMAND_INSTR(0x50, 0x10),
-	ILI9881C_COMMAND_INSTR(0x51, 0x32),
-	ILI9881C_COMMAND_INSTR(0x52, 0x54),
-	ILI9881C_COMMAND_INSTR(0x53, 0x76),
-	ILI9881C_COMMAND_INSTR(0x54, 0x98),
-	ILI9881C_COMMAND_INSTR(0x55, 0xba),
-	ILI9881C_COMMAND_INSTR(0x56, 0x10),
-	ILI9881C_COMMAND_INSTR(0x57, 0x32),
-	ILI9881C_COMMAND_INSTR(0x58, 0x54),
-	ILI9881C_COMMAND_INSTR(0x59, 0x76),
-	ILI9881C_COMMAND_INSTR(0x5A, 0x98),
-	ILI9881C_COMMAND_INSTR(0x5B, 0xba),
-	ILI9881C_COMMAND_INSTR(0x5C, 0xdc),
-	ILI9881C_COMMAND_INSTR(0x5D, 0xfe),
+	return 0;
+}
 
-	//GIP_3
-	ILI9881C_COMMAND_INSTR(0x5E, 0x00),
-	ILI9881C_COMMAND_INSTR(0x5F, 0x01),
-	ILI9881C_COMMAND_INSTR(0x60, 0x00),
-	ILI9881C_COMMAND_INSTR(0x61, 0x15),
-	ILI9881C_COMMAND_INSTR(0x62, 0x14),
-	ILI9881C_COMMAND_INSTR(0x63, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x64, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x65, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x66, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x67, 0x06),
-	ILI9881C_COMMAND_INSTR(0x68, 0x02),
-	ILI9881C_COMMAND_INSTR(0x69, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6A, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6B, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6C, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6D, 0x02),
-	ILI9881C_COMMAND_INSTR(0x6E, 0x07),
-	ILI9881C_COMMAND_INSTR(0x6F, 0x02),
-	ILI9881C_COMMAND_INSTR(0x70, 0x02),
-	ILI9881C_COMMAND_INSTR(0x71, 0x02),
-	ILI9881C_COMMAND_INSTR(0x72, 0x02),
-	ILI9881C_COMMAND_INSTR(0x73, 0x02),
-	ILI9881C_COMMAND_INSTR(0x74, 0x02),
-
-	ILI9881C_COMMAND_INSTR(0x75, 0x01),
-	ILI9881C_COMMAND_INSTR(0x76, 0x00),
-	ILI9881C_COMMAND_INSTR(0x77, 0x14),
-	ILI9881C_COMMAND_INSTR(0x78, 0x15),
-	ILI9881C_COMMAND_INSTR(0x79, 0x0E),
-	ILI9881C_COMMAND_INSTR(0x7A, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x7B, 0x0C),
-	ILI9881C_COMMAND_INSTR(0x7C, 0x0D),
-	ILI9881C_COMMAND_INSTR(0x7D, 0x06),
-	ILI9881C_COMMAND_INSTR(0x7E, 0x02),
-	ILI9881C_COMMAND_INSTR(0x7F, 0x02),
-	ILI9881C_COMMAND_INSTR(0x80, 0x02),
-	ILI9881C_COMMAND_INSTR(0x81, 0x02),
-	ILI9881C_COMMAND_INSTR(0x82, 0x02),
-	ILI9881C_COMMAND_INSTR(0x83, 0x02),
-	ILI9881C_COMMAND_INSTR(0x84, 0x07),
-	ILI9881C_COMMAND_INSTR(0x85, 0x02),
-	ILI9881C_COMMAND_INSTR(0x86, 0x02),
-	ILI9881C_COMMAND_INSTR(0x87, 0x02),
-	ILI9881C_COMMAND_INSTR(0x88, 0x02),
-	ILI9881C_COMMAND_INSTR(0x89, 0x02),
-	ILI9881C_COMMAND_INSTR(0x8A, 0x02),
-
-	ILI9881C_SWITCH_PAGE_INSTR(4),
-	ILI9881C_COMMAND_INSTR(0x6C, 0x15),
-	ILI9881C_COMMAND_INSTR(0x6E, 0x2A),
+static int ili9881c_cooling_get_cur_state(struct thermal_cooling_device *cdev,
+					  unsigned long *state)
+{
+	struct ili9881c *ctx = cdev->devdata;
 
-	//clamp 15V
-	ILI9881C_COMMAND_INSTR(0x6F, 0x35),
-	ILI9881C_COMMAND_INSTR(0x3A, 0x92),
-	ILI9881C_COMMAND_INSTR(0x8D, 0x1F),
-	ILI9881C_COMMAND_INSTR(0x87, 0xBA),
-	ILI9881C_COMMAND_INSTR(0x26, 0x76),
-	ILI9881C_COMMAND_INSTR(0xB2, 0xD1),
-	ILI9881C_COMMAND_INSTR(0xB5, 0x27),
-	ILI9881C_COMMAND_INSTR(0x31, 0x75),
-	ILI9881C_COMMAND_INSTR(0x30, 0x03),
-	ILI9881C_COMMAND_INSTR(0x3B, 0x98),
-	ILI9881C_COMMAND_INSTR(0x35, 0x17),
-	ILI9881C_COMMAND_INSTR(0x33, 0x14),
-	ILI9881C_COMMAND_INSTR(0x38, 0x01),
-	ILI9881C_COMMAND_INSTR(0x39, 0x00),
-
-	ILI9881C_SWITCH_PAGE_INSTR(1),
-	// direction rotate
-	//ILI9881C_COMMAND_INSTR(0x22, 0x0B),
-	ILI9881C_COMMAND_INSTR(0x22, 0x0A),
-	ILI9881C_COMMAND_INSTR(0x31, 0x00),
-	ILI9881C_COMMAND_INSTR(0x53, 0x63),
-	ILI9881C_COMMAND_INSTR(0x55, 0x69),
-	ILI9881C_COMMAND_INSTR(0x50, 0xC7),
-	ILI9881C_COMMAND_INSTR(0x51, 0xC2),
-	ILI9881C_COMMAND_INSTR(0x60, 0x26),
-
-	ILI9881C_COMMAND_INSTR(0xA0, 0x08),
-	ILI9881C_COMMAND_INSTR(0xA1, 0x0F),
-	ILI9881C_COMMAND_INSTR(0xA2, 0x25),
-	ILI9881C_COMMAND_INSTR(0xA3, 0x01),
-	ILI9881C_COMMAND_INSTR(0xA4, 0x23),
-	ILI9881C_COMMAND_INSTR(0xA5, 0x18),
-	ILI9881C_COMMAND_INSTR(0xA6, 0x11),
-	ILI9881C_COMMAND_INSTR(0xA7, 0x1A),
-	ILI9881C_COMMAND_INSTR(0xA8, 0x81),
-	ILI9881C_COMMAND_INSTR(0xA9, 0x19),
-	ILI9881C_COMMAND_INSTR(0xAA, 0x26),
-	ILI9881C_COMMAND_INSTR(0xAB, 0x7C),
-	ILI9881C_COMMAND_INSTR(0xAC, 0x24),
-	ILI9881C_COMMAND_INSTR(0xAD, 0x1E),
-	ILI9881C_COMMAND_INSTR(0xAE, 0x5C),
-	ILI9881C_COMMAND_INSTR(0xAF, 0x2A),
-	ILI9881C_COMMAND_INSTR(0xB0, 0x2B),
-	ILI9881C_COMMAND_INSTR(0xB1, 0x50),
-	ILI9881C_COMMAND_INSTR(0xB2, 0x5C),
-	ILI9881C_COMMAND_INSTR(0xB3, 0x39),
-
-	ILI9881C_COMMAND_INSTR(0xC0, 0x08),
-	ILI9881C_COMMAND_INSTR(0xC1, 0x1F),
-	ILI9881C_COMMAND_INSTR(0xC2, 0x24),
-	ILI9881C_COMMAND_INSTR(0xC3, 0x1D),
-	ILI9881C_COMMAND_INSTR(0xC4, 0x04),
-	ILI9881C_COMMAND_INSTR(0xC5, 0x32),
-	ILI9881C_COMMAND_INSTR(0xC6, 0x24),
-	ILI9881C_COMMAND_INSTR(0xC7, 0x1F),
-	ILI9881C_COMMAND_INSTR(0xC8, 0x90),
-	ILI9881C_COMMAND_INSTR(0xC9, 0x20),
-	ILI9881C_COMMAND_INSTR(0xCA, 0x2C),
-	ILI9881C_COMMAND_INSTR(0xCB, 0x82),
-	ILI9881C_COMMAND_INSTR(0xCC, 0x19),
-	ILI9881C_COMMAND_INSTR(0xCD, 0x22),
-	ILI9881C_COMMAND_INSTR(0xCE, 0x4E),
-	ILI9881C_COMMAND_INSTR(0xCF, 0x28),
-	ILI9881C_COMMAND_INSTR(0xD0, 0x2D),
-	ILI9881C_COMMAND_INSTR(0xD1, 0x51),
-	ILI9881C_COMMAND_INSTR(0xD2, 0x5D),
-	ILI9881C_COMMAND_INSTR(0xD3, 0x39),
-
-	ILI9881C_SWITCH_PAGE_INSTR(0),
-	//PWM
-	ILI9881C_COMMAND_INSTR(0x51, 0x0F),
-	ILI9881C_COMMAND_INSTR(0x52, 0xFF),
-	ILI9881C_COMMAND_INSTR(0x53, 0x2C),
+	*state = READ_ONCE(ctx->cooling_state);
 
-	ILI9881C_COMMAND_INSTR(0x11, 0x00),
-	ILI9881C_COMMAND_INSTR(0x29, 0x00),
-	ILI9881C_COMMAND_INSTR(0x35, 0x00),
-};
+	return 0;
+}
 
-static inline struct ili9881c *panel_to_ili9881c(struct drm_panel *panel)
+/*
+ * The refresh rate can't be changed from here, a panel can't trigger a
+ * modeset. The low_refresh attribute tells userspace when the preferred
+ * mode changes, it's then up to it to probe the modes again.
+ */
+static int ili9881c_cooling_set_cur_state(struct thermal_cooling_device *cdev,
+					  unsigned long state)
 {
-	return container_of(panel, struct ili9881c, panel);
+	struct ili9881c *ctx = cdev->devdata;
+	bool low_refresh, changed;
+
+	if (state >= ARRAY_SIZE(ili9881c_cooling_states))
+		return -EINVAL;
+
+	mutex_lock(&ctx->lock);
+
+	low_refresh = ili9881c_cooling_states[ctx->cooling_state].low_refresh;
+	ctx->cooling_state = state;
+	ili9881c_apply_cooling(ctx);
+
+	changed = ctx->desc->low_refresh &&
+		  ili9881c_cooling_states[state].low_refresh != low_refresh;
+
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+
+	if (changed)
+		sysfs_notify(&ctx->dsi->dev.kobj, NULL, "low_refresh");
+
+	return 0;
 }
 
+static const struct thermal_cooling_device_ops ili9881c_cooling_ops = {
+	.get_max_state	= ili9881c_cooling_get_max_state,
+	.get_cur_state	= ili9881c_cooling_get_cur_state,
+	.set_cur_state	= ili9881c_cooling_set_cur_state,
+};
+
+#if IS_ENABLED(CONFIG_INPUT)
 /*
- * The panel seems to accept some private DCS commands that map
- * directly to registers.
- *
- * It is organised by page, with each page having its own set of
- * registers, and the first page looks like it's holding the standard
- * DCS commands.
- *
- * So before any attempt at sending a command or data, we have to be
- * sure if we're in the right page or not.
+ * This runs right after the touchscreen driver reported the touch, in
+ * parallel with its delivery to userspace. The handler runs in atomic
+ * context, the actual work is deferred.
  */
-static int ili9881c_switch_page(struct ili9881c *ctx, u8 page)
+static void ili9881c_input_event(struct input_handle *handle,
+				 unsigned int type, unsigned int code,
+				 int value)
 {
-	u8 buf[4] = { 0xff, 0x98, 0x81, page };
-	int ret;
+	struct ili9881c *ctx = handle->handler->private;
 
-	ret = mipi_dsi_dcs_write_buffer(ctx->dsi, buf, sizeof(buf));
-	if (ret < 0)
-		return ret;
+	if (type != EV_KEY || code != BTN_TOUCH || !value)
+		return;
 
-	return 0;
+	if (READ_ONCE(ctx->ambient) ||
+	    (!READ_ONCE(ctx->prepared) && !READ_ONCE(ctx->powered)))
+		schedule_work(&ctx->wake_work);
 }
 
-static int ili9881c_send_cmd_data(struct ili9881c *ctx, u8 cmd, u8 data)
+static int ili9881c_input_connect(struct input_handler *handler,
+				  struct input_dev *dev,
+				  const struct input_device_id *id)
 {
-	u8 buf[2] = { cmd, data };
+	struct input_handle *handle;
 	int ret;
 
-	ret = mipi_dsi_dcs_write_buffer(ctx->dsi, buf, sizeof(buf));
-	if (ret < 0)
-		return ret;
+	handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+	if (!handle)
+		return -ENOMEM;
+
+	handle->dev = dev;
+	handle->handler = handler;
+	handle->name = handler->name;
+
+	ret = input_register_handle(handle);
+	if (ret)
+		goto err_free_handle;
+
+	ret = input_open_device(handle);
+	if (ret)
+		goto err_unregister_handle;
 
 	return 0;
+
+err_unregister_handle:
+	input_unregister_handle(handle);
+err_free_handle:
+	kfree(handle);
+	return ret;
 }
 
-static int ili9881c_prepare(struct drm_panel *panel)
+static void ili9881c_input_disconnect(struct input_handle *handle)
+{
+	input_close_device(handle);
+	input_unregister_handle(handle);
+	kfree(handle);
+}
+
+/*
+ * The touchscreen in front of the panel: the Goodix GT9271 of the
+ * CutiePi, which the goodix driver reports with its ID as the product.
+ */
+static const struct input_device_id ili9881c_input_ids[] = {
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_BUS |
+			 INPUT_DEVICE_ID_MATCH_VENDOR |
+			 INPUT_DEVICE_ID_MATCH_PRODUCT |
+			 INPUT_DEVICE_ID_MATCH_EVBIT |
+			 INPUT_DEVICE_ID_MATCH_KEYBIT,
+		.bustype = BUS_I2C,
+		.vendor = 0x0416,
+		.product = 9271,
+		.evbit = { BIT_MASK(EV_KEY) },
+		.keybit = { [BIT_WORD(BTN_TOUCH)] = BIT_MASK(BTN_TOUCH) },
+	},
+	{ },
+};
+
+/* Touch wakes the panel up faster, it's not worth failing for */
+static void ili9881c_input_register(struct ili9881c *ctx)
 {
-	struct ili9881c *ctx = panel_to_ili9881c(panel);
-	unsigned int i;
 	int ret;
 
-	/* Power the panel */
-	ret = regulator_enable(ctx->power);
+	ctx->input_handler.event = ili9881c_input_event;
+	ctx->input_handler.connect = ili9881c_input_connect;
+	ctx->input_handler.disconnect = ili9881c_input_disconnect;
+	ctx->input_handler.name = "ili9881c";
+	ctx->input_handler.id_table = ili9881c_input_ids;
+	ctx->input_handler.private = ctx;
+
+	ret = input_register_handler(&ctx->input_handler);
 	if (ret)
-		return ret;
-	msleep(5);
+		dev_warn(&ctx->dsi->dev,
+			 "Couldn't register the touch handler: %d\n", ret);
+	else
+		ctx->input_registered = true;
+}
 
-	/* And reset it */
-	gpiod_set_value(ctx->reset, 1);
-	msleep(20);
+static void ili9881c_input_unregister(struct ili9881c *ctx)
+{
+	if (ctx->input_registered)
+		input_unregister_handler(&ctx->input_handler);
+	ctx->input_registered = false;
+}
+#else
+static void ili9881c_input_register(struct ili9881c *ctx)
+{
+}
 
-	gpiod_set_value(ctx->reset, 0);
-	msleep(20);
+static void ili9881c_input_unregister(struct ili9881c *ctx)
+{
+}
+#endif
 
-	for (i = 0; i < ctx->desc->init_length; i++) {
-		const struct ili9881c_instr *instr = &ctx->desc->init[i];
+static int ili9881c_prepare(struct drm_panel *panel)
+{
+	struct ili9881c *ctx = panel_to_ili9881c(panel);
+	int ret = 0;
 
-		if (instr->op == ILI9881C_SWITCH_PAGE)
-			ret = ili9881c_switch_page(ctx, instr->arg.page);
-		else if (instr->op == ILI9881C_COMMAND)
-			ret = ili9881c_send_cmd_data(ctx, instr->arg.cmd.cmd,
-						      instr->arg.cmd.data);
+	mutex_lock(&ctx->lock);
 
-		if (ret)
-			return ret;
+	if (!ctx->prepared) {
+		ret = ili9881c_power_on(ctx);
+		if (!ret)
+			ctx->prepared = true;
 	}
 
-	ret = ili9881c_switch_page(ctx, 0);
-	if (ret)
-		return ret;
-
-	ret = mipi_dsi_dcs_set_tear_on(ctx->dsi, MIPI_DSI_DCS_TEAR_MODE_VBLANK);
-	if (ret)
-		return ret;
-
-	ret = mipi_dsi_dcs_exit_sleep_mode(ctx->dsi);
-	if (ret)
-		return ret;
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
 
-	return 0;
+	return ret;
 }
 
 static int ili9881c_enable(struct drm_panel *panel)
 {
 	struct ili9881c *ctx = panel_to_ili9881c(panel);
+	int ret = 0;
 
-	msleep(120);
+	mutex_lock(&ctx->lock);
 
-	mipi_dsi_dcs_set_display_on(ctx->dsi);
+	if (!ctx->enabled) {
+		ret = ili9881c_display_on(ctx);
+		if (ret)
+			goto out;
+		ctx->enabled = true;
 
-	return 0;
+		/* Before drm_panel_enable() turns the backlight on */
+		ili9881c_apply_cooling(ctx);
+
+		ili9881c_esd_schedule(ctx);
+	}
+
+out:
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+
+	return ret;
 }
 
 static int ili9881c_disable(struct drm_panel *panel)
 {
 	struct ili9881c *ctx = panel_to_ili9881c(panel);
+	int ret = 0;
+
+	cancel_delayed_work_sync(&ctx->esd_work);
+
+	mutex_lock(&ctx->lock);
+
+	if (ctx->enabled) {
+		ili9881c_exit_ambient(ctx);
+		ret = ili9881c_dcs_write(ctx, MIPI_DCS_SET_DISPLAY_OFF, NULL, 0);
+		ctx->enabled = false;
+	}
 
-	return mipi_dsi_dcs_set_display_off(ctx->dsi);
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+
+	return ret;
 }
 
 static int ili9881c_unprepare(struct drm_panel *panel)
 {
 	struct ili9881c *ctx = panel_to_ili9881c(panel);
 
-	mipi_dsi_dcs_enter_sleep_mode(ctx->dsi);
-	regulator_disable(ctx->power);
-	gpiod_set_value(ctx->reset, 1);
+	mutex_lock(&ctx->lock);
+
+	if (ctx->prepared) {
+		ili9881c_power_off(ctx);
+		ctx->prepared = false;
+	}
+
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
 
 	return 0;
 }
 
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_LHR050H41)
 static const struct drm_display_mode lhr050h41_default_mode = {
 	.clock		= 62000,
 
@@ -807,7 +1843,9 @@ static const struct drm_display_mode lhr050h41_default_mode = {
 	.width_mm	= 62,
 	.height_mm	= 110,
 };
+#endif
 
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_K101_IM2BYL02)
 static const struct drm_display_mode k101_im2byl02_default_mode = {
 	.clock		= 69700,
 
@@ -824,48 +1862,125 @@ static const struct drm_display_mode k101_im2byl02_default_mode = {
 	.width_mm	= 135,
 	.height_mm	= 217,
 };
+#endif
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_NWE080)
+/*
+ * The NWE080 was driven with two sets of timings, both are exposed so
+ * that units tuned for the second one can still select it.
+ */
+/*
+ * The timings and the DSI flags of nwe080_desc go together, both come
+ * from this driver. The former panel-nwe080.c paired a 70.858 MHz mode
+ * with burst mode flags, don't mix the two.
+ */
+static const struct drm_display_mode nwe080_modes[] = {
+	{
+		.clock		= 71750,
+
+		.hdisplay	= 800,
+		.hsync_start	= 800 + 52,
+		.hsync_end	= 800 + 52 + 8,
+		.htotal		= 800 + 52 + 8 + 48,
+
+		.vdisplay	= 1280,
+		.vsync_start	= 1280 + 16,
+		.vsync_end	= 1280 + 16 + 6,
+		.vtotal		= 1280 + 16 + 6 + 15,
+
+		.width_mm	= 107,
+		.height_mm	= 170,
+	},
+};
+#endif
 
-static const struct drm_display_mode nwe080_default_mode = {
-	.clock 		= 71750,
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_JD9366)
+static const struct drm_display_mode jd9366_default_mode = {
+	.clock		= 68430,
 
 	.hdisplay	= 800,
-	.hsync_start	= 800 + 52,
-	.hsync_end	= 800 + 52 + 8,
-	.htotal		= 800 + 52 + 8 + 48,
+	.hsync_start	= 800 + 16,
+	.hsync_end	= 800 + 16 + 48,
+	.htotal		= 800 + 16 + 48 + 16,
 
 	.vdisplay	= 1280,
-	.vsync_start	= 1280 + 16,
-	.vsync_end	= 1280 + 16 + 6,
-	.vtotal		= 1280 + 16 + 6 + 15,
+	.vsync_start	= 1280 + 8,
+	.vsync_end	= 1280 + 8 + 4,
+	.vtotal		= 1280 + 8 + 4 + 4,
 
-	.width_mm 	= 107,
-	.height_mm 	= 170,
+	.width_mm	= 107,
+	.height_mm	= 172,
 };
+#endif
 
 static int ili9881c_get_modes(struct drm_panel *panel,
 			      struct drm_connector *connector)
 {
 	struct ili9881c *ctx = panel_to_ili9881c(panel);
+	const struct ili9881c_desc *desc;
 	struct drm_display_mode *mode;
-
-	mode = drm_mode_duplicate(connector->dev, ctx->desc->mode);
-	if (!mode) {
-		dev_err(&ctx->dsi->dev, "failed to add mode %ux%ux@%u\n",
-			ctx->desc->mode->hdisplay,
-			ctx->desc->mode->vdisplay,
-			drm_mode_vrefresh(ctx->desc->mode));
-		return -ENOMEM;
+	bool low_refresh;
+	unsigned int i;
+	int count;
+
+	mutex_lock(&ctx->lock);
+	desc = ctx->desc;
+	low_refresh = desc->low_refresh &&
+		      ili9881c_cooling_states[ctx->cooling_state].low_refresh;
+	mutex_unlock(&ctx->lock);
+
+	for (i = 0; i < desc->num_modes; i++) {
+		const struct drm_display_mode *desc_mode = &desc->modes[i];
+
+		mode = drm_mode_duplicate(connector->dev, desc_mode);
+		if (!mode) {
+			dev_err(&ctx->dsi->dev, "failed to add mode %ux%ux@%u\n",
+				desc_mode->hdisplay,
+				desc_mode->vdisplay,
+				drm_mode_vrefresh(desc_mode));
+			return -ENOMEM;
+		}
+
+		drm_mode_set_name(mode);
+
+		mode->type = DRM_MODE_TYPE_DRIVER;
+		if (i == 0 && !low_refresh)
+			mode->type |= DRM_MODE_TYPE_PREFERRED;
+		drm_mode_probed_add(connector, mode);
+	}
+	count = desc->num_modes;
+
+	/*
+	 * The preferred timings with a longer vertical front porch. The
+	 * pixel clock, and with it the DSI link rate, stays the same.
+	 */
+	if (desc->low_refresh) {
+		const struct drm_display_mode *desc_mode = &desc->modes[0];
+		unsigned int vfp;
+
+		mode = drm_mode_duplicate(connector->dev, desc_mode);
+		if (!mode)
+			return -ENOMEM;
+
+		vfp = DIV_ROUND_CLOSEST(desc_mode->clock * 1000,
+					desc_mode->htotal * desc->low_refresh) -
+		      desc_mode->vtotal;
+		mode->vsync_start += vfp;
+		mode->vsync_end += vfp;
+		mode->vtotal += vfp;
+		drm_mode_set_name(mode);
+
+		mode->type = DRM_MODE_TYPE_DRIVER;
+		if (low_refresh)
+			mode->type |= DRM_MODE_TYPE_PREFERRED;
+		drm_mode_probed_add(connector, mode);
+		count++;
 	}
 
-	drm_mode_set_name(mode);
-
-	mode->type = DRM_MODE_TYPE_DRIVER | DRM_MODE_TYPE_PREFERRED;
-	drm_mode_probed_add(connector, mode);
-
-	connector->display_info.width_mm = mode->width_mm;
-	connector->display_info.height_mm = mode->height_mm;
+	connector->display_info.width_mm = desc->modes[0].width_mm;
+	connector->display_info.height_mm = desc->modes[0].height_mm;
 
-	return 1;
+	return count;
 }
 
 static const struct drm_panel_funcs ili9881c_funcs = {
@@ -876,6 +1991,136 @@ static const struct drm_panel_funcs ili9881c_funcs = {
 	.get_modes	= ili9881c_get_modes,
 };
 
+#define ILI9881C_COUNTER_ATTR(_name)					\
+static ssize_t _name##_show(struct device *dev,			\
+			    struct device_attribute *attr, char *buf)	\
+{									\
+	struct ili9881c *ctx = dev_get_drvdata(dev);			\
+									\
+	return sysfs_emit(buf, "%u\n", READ_ONCE(ctx->_name));	\
+}									\
+static DEVICE_ATTR_RO(_name)
+
+ILI9881C_COUNTER_ATTR(esd_checks);
+ILI9881C_COUNTER_ATTR(esd_sleep_recoveries);
+ILI9881C_COUNTER_ATTR(esd_page_recoveries);
+ILI9881C_COUNTER_ATTR(esd_reset_recoveries);
+ILI9881C_COUNTER_ATTR(init_retries);
+ILI9881C_COUNTER_ATTR(init_failures);
+ILI9881C_COUNTER_ATTR(touch_wakes);
+
+static ssize_t ambient_show(struct device *dev,
+			    struct device_attribute *attr, char *buf)
+{
+	struct ili9881c *ctx = dev_get_drvdata(dev);
+
+	return sysfs_emit(buf, "%d\n", READ_ONCE(ctx->ambient));
+}
+
+static ssize_t ambient_store(struct device *dev,
+			     struct device_attribute *attr,
+			     const char *buf, size_t count)
+{
+	struct ili9881c *ctx = dev_get_drvdata(dev);
+	bool ambient;
+	int ret;
+
+	ret = kstrtobool(buf, &ambient);
+	if (ret)
+		return ret;
+
+	mutex_lock(&ctx->lock);
+	if (ambient)
+		ret = ili9881c_enter_ambient(ctx);
+	else
+		ret = ili9881c_exit_ambient(ctx);
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+
+	return ret ? ret : count;
+}
+static DEVICE_ATTR_RW(ambient);
+
+/* Whether the cooling device made the low refresh mode the preferred one */
+static ssize_t low_refresh_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct ili9881c *ctx = dev_get_drvdata(dev);
+	unsigned long state = READ_ONCE(ctx->cooling_state);
+
+	return sysfs_emit(buf, "%d\n", ctx->desc->low_refresh &&
+			  ili9881c_cooling_states[state].low_refresh);
+}
+static DEVICE_ATTR_RO(low_refresh);
+
+static const char * const ili9881c_bl_bucket_names[ILI9881C_BL_BUCKETS] = {
+	"backlight_off", "backlight_low", "backlight_mid", "backlight_high",
+};
+
+/*
+ * Time spent in each panel state and backlight level in ms, and the
+ * number of times each state was entered.
+ */
+static int ili9881c_residency_show(struct seq_file *m, void *data)
+{
+	struct ili9881c *ctx = m->private;
+	struct ili9881c_residency res;
+	unsigned int i;
+
+	mutex_lock(&ctx->lock);
+	ili9881c_account(ctx);
+	res = ctx->res;
+	mutex_unlock(&ctx->lock);
+
+	for (i = 0; i < ILI9881C_NUM_STATES; i++)
+		seq_printf(m, "%s %llu %u\n", ili9881c_state_names[i],
+			   div_u64(res.state_us[i], 1000), res.transitions[i]);
+
+	for (i = 0; i < ILI9881C_BL_BUCKETS; i++)
+		seq_printf(m, "%s %llu\n", ili9881c_bl_bucket_names[i],
+			   div_u64(res.bl_us[i], 1000));
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ili9881c_residency);
+
+static void ili9881c_debugfs_remove(void *data)
+{
+	debugfs_remove_recursive(data);
+}
+
+/* Next to the DSI trace, the statistics are just as optional */
+static void ili9881c_debugfs_init(struct ili9881c *ctx)
+{
+	struct device *dev = &ctx->dsi->dev;
+	struct dentry *dir;
+	char name[64];
+
+	snprintf(name, sizeof(name), "ili9881c.%s", dev_name(dev));
+	dir = debugfs_create_dir(name, NULL);
+	debugfs_create_file("residency", 0400, dir, ctx,
+			    &ili9881c_residency_fops);
+
+	devm_add_action_or_reset(dev, ili9881c_debugfs_remove, dir);
+}
+
+static struct attribute *ili9881c_attrs[] = {
+	&dev_attr_esd_checks.attr,
+	&dev_attr_esd_sleep_recoveries.attr,
+	&dev_attr_esd_page_recoveries.attr,
+	&dev_attr_esd_reset_recoveries.attr,
+	&dev_attr_init_retries.attr,
+	&dev_attr_init_failures.attr,
+	&dev_attr_touch_wakes.attr,
+	&dev_attr_ambient.attr,
+	&dev_attr_low_refresh.attr,
+	NULL,
+};
+
+static const struct attribute_group ili9881c_attr_group = {
+	.attrs = ili9881c_attrs,
+};
+
 static int ili9881c_dsi_probe(struct mipi_dsi_device *dsi)
 {
 	struct ili9881c *ctx;
@@ -886,71 +2131,259 @@ static int ili9881c_dsi_probe(struct mipi_dsi_device *dsi)
 		return -ENOMEM;
 	mipi_dsi_set_drvdata(dsi, ctx);
 	ctx->dsi = dsi;
+	panel_dsi_trace_init(&ctx->trace, dsi, dsi_trace);
+	/* NULL for the generic compatible, see ili9881c_identify() */
 	ctx->desc = of_device_get_match_data(&dsi->dev);
 
+	mutex_init(&ctx->lock);
+	INIT_DELAYED_WORK(&ctx->esd_work, ili9881c_esd_work);
+	INIT_WORK(&ctx->power_work, ili9881c_power_work);
+	INIT_WORK(&ctx->wake_work, ili9881c_wake_work);
+	INIT_DELAYED_WORK(&ctx->wake_timeout, ili9881c_wake_timeout);
+
 	drm_panel_init(&ctx->panel, &dsi->dev, &ili9881c_funcs,
 		       DRM_MODE_CONNECTOR_DSI);
 
 	ctx->power = devm_regulator_get(&dsi->dev, "power");
-	if (IS_ERR(ctx->power)) {
-		dev_err(&dsi->dev, "Couldn't get our power regulator\n");
-		return PTR_ERR(ctx->power);
-	}
+	if (IS_ERR(ctx->power))
+		return dev_err_probe(&dsi->dev, PTR_ERR(ctx->power),
+				     "Couldn't get our power regulator\n");
 
-	ctx->reset = devm_gpiod_get(&dsi->dev, "reset", GPIOD_OUT_LOW);
-	if (IS_ERR(ctx->reset)) {
-		dev_err(&dsi->dev, "Couldn't get our reset GPIO\n");
-		return PTR_ERR(ctx->reset);
-	}
+	ctx->reset = devm_gpiod_get_optional(&dsi->dev, "reset", GPIOD_OUT_LOW);
+	if (IS_ERR(ctx->reset))
+		return dev_err_probe(&dsi->dev, PTR_ERR(ctx->reset),
+				     "Couldn't get our reset GPIO\n");
 
+	/* The backlight driver often probes after us */
 	ret = drm_panel_of_backlight(&ctx->panel);
 	if (ret)
-		return ret;
+		return dev_err_probe(&dsi->dev, ret,
+				     "Couldn't get our backlight\n");
 
-	drm_panel_add(&ctx->panel);
+	if (ctx->panel.backlight)
+		ctx->max_brightness = ctx->panel.backlight->props.max_brightness;
+	ctx->res.since = ktime_get();
 
-	dsi->mode_flags = ctx->desc->flags;
 	dsi->format = MIPI_DSI_FMT_RGB888;
 	dsi->lanes = 4;
 
-	return mipi_dsi_attach(dsi);
+	if (!ctx->desc) {
+		ret = ili9881c_identify(ctx);
+		if (ret)
+			return dev_err_probe(&dsi->dev, ret,
+					     "Couldn't identify the panel\n");
+	}
+
+	ret = devm_device_add_group(&dsi->dev, &ili9881c_attr_group);
+	if (ret)
+		goto err_power_off;
+
+	ili9881c_debugfs_init(ctx);
+
+	drm_panel_add(&ctx->panel);
+
+	dsi->mode_flags = ctx->desc->flags;
+
+	ret = mipi_dsi_attach(dsi);
+	if (ret)
+		goto err_remove_panel;
+
+	ili9881c_input_register(ctx);
+
+	/* Same for the cooling device, thermal zones may not use it anyway */
+	if (IS_ENABLED(CONFIG_THERMAL))
+		ctx->cooling = thermal_of_cooling_device_register(dsi->dev.of_node,
+								  "ili9881c", ctx,
+								  &ili9881c_cooling_ops);
+	if (IS_ERR(ctx->cooling)) {
+		dev_warn(&dsi->dev, "Couldn't register the cooling device: %ld\n",
+			 PTR_ERR(ctx->cooling));
+		ctx->cooling = NULL;
+	}
+
+	/* The identification already powered the panel up */
+	if (ctx->powered)
+		mod_delayed_work(system_wq, &ctx->wake_timeout,
+				 msecs_to_jiffies(ILI9881C_WAKE_TIMEOUT_MS));
+	else
+		schedule_work(&ctx->power_work);
+
+	return 0;
+
+err_remove_panel:
+	drm_panel_remove(&ctx->panel);
+err_power_off:
+	if (ctx->powered) {
+		gpiod_set_value(ctx->reset, 1);
+		regulator_disable(ctx->power);
+	}
+
+	return ret;
 }
 
 static int ili9881c_dsi_remove(struct mipi_dsi_device *dsi)
 {
 	struct ili9881c *ctx = mipi_dsi_get_drvdata(dsi);
 
+	ili9881c_input_unregister(ctx);
+
+	if (ctx->cooling)
+		thermal_cooling_device_unregister(ctx->cooling);
+
 	mipi_dsi_detach(dsi);
 	drm_panel_remove(&ctx->panel);
+	cancel_delayed_work_sync(&ctx->esd_work);
+	cancel_work_sync(&ctx->power_work);
+	cancel_work_sync(&ctx->wake_work);
+	cancel_delayed_work_sync(&ctx->wake_timeout);
+
+	if (ctx->powered) {
+		gpiod_set_value(ctx->reset, 1);
+		regulator_disable(ctx->power);
+	}
+
+	return 0;
+}
+
+/*
+ * Power is about to be cut: turn the backlight off first so that the
+ * panel discharging doesn't show, and skip the usual power state
+ * delays.
+ */
+static void ili9881c_dsi_shutdown(struct mipi_dsi_device *dsi)
+{
+	struct ili9881c *ctx = mipi_dsi_get_drvdata(dsi);
+
+	/* A touch would power the panel back up */
+	ili9881c_input_unregister(ctx);
+
+	cancel_delayed_work_sync(&ctx->esd_work);
+	cancel_work_sync(&ctx->power_work);
+	cancel_work_sync(&ctx->wake_work);
+	cancel_delayed_work_sync(&ctx->wake_timeout);
+
+	backlight_disable(ctx->panel.backlight);
+
+	mutex_lock(&ctx->lock);
+
+	if (ctx->enabled)
+		ili9881c_dcs_write(ctx, MIPI_DCS_SET_DISPLAY_OFF, NULL, 0);
+
+	if (ctx->prepared) {
+		ili9881c_power_off(ctx);
+	} else if (ctx->powered) {
+		gpiod_set_value(ctx->reset, 1);
+		regulator_disable(ctx->power);
+	}
+
+	ctx->enabled = false;
+	ctx->prepared = false;
+	ctx->powered = false;
+	ctx->ambient = false;
+
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
+}
+
+static int __maybe_unused ili9881c_suspend(struct device *dev)
+{
+	struct ili9881c *ctx = dev_get_drvdata(dev);
+
+	cancel_work_sync(&ctx->power_work);
+	cancel_work_sync(&ctx->wake_work);
+	cancel_delayed_work_sync(&ctx->wake_timeout);
+
+	/* Don't keep a panel that DRM never prepared powered */
+	mutex_lock(&ctx->lock);
+
+	ctx->prepared_at_suspend = ctx->prepared;
+	if (ctx->powered && !ctx->prepared) {
+		gpiod_set_value(ctx->reset, 1);
+		regulator_disable(ctx->power);
+		ctx->powered = false;
+	}
+
+	ili9881c_account(ctx);
+	mutex_unlock(&ctx->lock);
 
 	return 0;
 }
 
+static int __maybe_unused ili9881c_resume(struct device *dev)
+{
+	struct ili9881c *ctx = dev_get_drvdata(dev);
+
+	/* A panel that was off stays off until something prepares it */
+	if (ctx->prepared_at_suspend)
+		schedule_work(&ctx->power_work);
+
+	return 0;
+}
+
+static SIMPLE_DEV_PM_OPS(ili9881c_pm_ops, ili9881c_suspend, ili9881c_resume);
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_LHR050H41)
 static const struct ili9881c_desc lhr050h41_desc = {
 	.init = lhr050h41_init,
 	.init_length = ARRAY_SIZE(lhr050h41_init),
-	.mode = &lhr050h41_default_mode,
+	.modes = &lhr050h41_default_mode,
+	.num_modes = 1,
 	.flags = MIPI_DSI_MODE_VIDEO_SYNC_PULSE,
+	.switch_page = ili9881c_page_ili9881c,
 };
+#endif
 
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_K101_IM2BYL02)
 static const struct ili9881c_desc k101_im2byl02_desc = {
 	.init = k101_im2byl02_init,
 	.init_length = ARRAY_SIZE(k101_im2byl02_init),
-	.mode = &k101_im2byl02_default_mode,
+	.modes = &k101_im2byl02_default_mode,
+	.num_modes = 1,
 	.flags = MIPI_DSI_MODE_VIDEO_SYNC_PULSE,
+	.switch_page = ili9881c_page_ili9881c,
 };
+#endif
 
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_NWE080)
 static const struct ili9881c_desc nwe080_desc = {
 	.init = nwe080_init,
 	.init_length = ARRAY_SIZE(nwe080_init),
-	.mode = &nwe080_default_mode,
+	.modes = nwe080_modes,
+	.num_modes = ARRAY_SIZE(nwe080_modes),
 	.flags = MIPI_DSI_MODE_VIDEO_SYNC_PULSE | MIPI_DSI_MODE_VIDEO,
+	.low_refresh = 30,
+	.reset_settle_ms = 100,
+	.switch_page = ili9881c_page_ili9881c,
+};
+#endif
+
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_JD9366)
+static const struct ili9881c_desc jd9366_desc = {
+	.init = panel_jd9366_init,
+	.init_length = PANEL_JD9366_INIT_LENGTH,
+	.modes = &jd9366_default_mode,
+	.num_modes = 1,
+	.flags = MIPI_DSI_MODE_VIDEO | MIPI_DSI_MODE_VIDEO_BURST |
+		 MIPI_DSI_MODE_LPM,
+	.low_refresh = 30,
+	.reset_settle_ms = 100,
+	.switch_page = ili9881c_page_jd9366,
 };
+#endif
 
 static const struct of_device_id ili9881c_of_match[] = {
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_LHR050H41)
 	{ .compatible = "bananapi,lhr050h41", .data = &lhr050h41_desc },
+#endif
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_K101_IM2BYL02)
 	{ .compatible = "feixin,k101-im2byl02", .data = &k101_im2byl02_desc },
+#endif
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_NWE080)
 	{ .compatible = "nwe,nwe080", .data = &nwe080_desc },
+#endif
+#if IS_ENABLED(CONFIG_DRM_PANEL_ILITEK_ILI9881C_CUTIEPI)
+	{ .compatible = "cutiepi,panel" },
+#endif
 	{}
 };
 MODULE_DEVICE_TABLE(of, ili9881c_of_match);
@@ -958,9 +2391,12 @@ MODULE_DEVICE_TABLE(of, ili9881c_of_match);
 static struct mipi_dsi_driver ili9881c_dsi_driver = {
 	.probe		= ili9881c_dsi_probe,
 	.remove		= ili9881c_dsi_remove,
+	.shutdown	= ili9881c_dsi_shutdown,
 	.driver = {
 		.name		= "ili9881c-dsi",
 		.of_match_table	= ili9881c_of_match,
+		.probe_type	= PROBE_PREFER_ASYNCHRONOUS,
+		.pm		= &ili9881c_pm_ops,
 	},
 };
 module_mipi_dsi_driver(ili9881c_dsi_driver);
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Shared code of the paged DSI panel drivers (ILI9881C, JD9366)
+ */
+
+#include <linux/delay.h>
+#include <linux/export.h>
+#include <linux/module.h>
+
+#include "panel-init-script.h"
+
+/**
+ * panel_init_send - send an init script one segment at a time
+ * @init: the script
+ * @length: number of instructions in @init
+ * @page: only send the segments writing to this page, or
+ *	PANEL_INIT_ALL_PAGES
+ * @send: sends one segment
+ * @data: passed to @send
+ * @retries: incremented for every segment sent again
+ *
+ * A segment failing with a transient error is sent again, up to
+ * PANEL_INIT_RETRIES times with an exponential backoff.
+ *
+ * Returns 0 or the error of the segment that couldn't be sent.
+ */
+int panel_init_send(const struct panel_init_instr *init, size_t length,
+		    int page, panel_init_send_fn send, void *data,
+		    unsigned int *retries)
+{
+	size_t start, end;
+	u8 cur = 0;
+	int ret;
+
+	for (start = 0; start < length; start = end) {
+		unsigned int tries = 0;
+
+		if (init[start].op == PANEL_INIT_SWITCH_PAGE)
+			cur = init[start].arg.page;
+
+		end = start + 1;
+		while (end < length && init[end].op != PANEL_INIT_SWITCH_PAGE)
+			end++;
+
+		if (page != PANEL_INIT_ALL_PAGES && page != cur)
+			continue;
+
+		while ((ret = send(data, &init[start], end - start, cur))) {
+			if (!panel_init_error_is_transient(ret) ||
+			    tries == PANEL_INIT_RETRIES)
+				return ret;
+
+			tries++;
+			(*retries)++;
+			usleep_range(1000 << tries, 2000 << tries);
+		}
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(panel_init_send);
+
+MODULE_DESCRIPTION("Shared code of the paged DSI panel drivers");
+MODULE_LICENSE("GPL v2");
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Init scripts of the paged DSI panel controllers
+ *
+ * An init script is a table of page switches and single byte register
+ * writes. How a page is selected depends on the controller, it's up to
+ * the driver. The script is sent one segment at a time, a new segment
+ * starting at each page switch: a segment only writes registers of a
+ * single page, so when one of its transfers fails it can be sent again
+ * on its own instead of giving up on the whole bring-up.
+ */
+
+#ifndef _PANEL_INIT_SCRIPT_H_
+#define _PANEL_INIT_SCRIPT_H_
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+enum panel_init_op {
+	PANEL_INIT_SWITCH_PAGE,
+	PANEL_INIT_COMMAND,
+};
+
+struct panel_init_instr {
+	enum panel_init_op	op;
+
+	union arg {
+		struct cmd {
+			u8	cmd;
+			u8	data;
+		} cmd;
+		u8	page;
+	} arg;
+};
+
+#define PANEL_INIT_SWITCH_PAGE_INSTR(_page)	\
+	{					\
+		.op = PANEL_INIT_SWITCH_PAGE,	\
+		.arg = {			\
+			.page = (_page),	\
+		},				\
+	}
+
+#define PANEL_INIT_COMMAND_INSTR(_cmd, _data)		\
+	{						\
+		.op = PANEL_INIT_COMMAND,		\
+		.arg = {				\
+			.cmd = {			\
+				.cmd = (_cmd),		\
+				.data = (_data),	\
+			},				\
+		},					\
+	}
+
+/* Send every segment, whatever its page */
+#define PANEL_INIT_ALL_PAGES	-1
+
+/* Number of times a failed segment is sent again */
+#define PANEL_INIT_RETRIES	3
+
+/*
+ * Errors worth sending a segment again for: the host failed the
+ * transfer, or timed out waiting for the panel. Anything else, such as
+ * a host that can't transfer at all, fails the same way every time.
+ */
+static inline bool panel_init_error_is_transient(int err)
+{
+	return err == -EIO || err == -ETIMEDOUT || err == -EAGAIN;
+}
+
+/*
+ * Sends a segment, that is @length instructions starting at @instr,
+ * all of them writing to @page. The first instruction is the page
+ * switch, except for the head of a script that doesn't start with one
+ * or when only the segments of one page are sent.
+ */
+typedef int (*panel_init_send_fn)(void *data,
+				  const struct panel_init_instr *instr,
+				  size_t length, u8 page);
+
+int panel_init_send(const struct panel_init_instr *init, size_t length,
+		    int page, panel_init_send_fn send, void *data,
+		    unsigned int *retries);
+
+#endif /* _PANEL_INIT_SCRIPT_H_ */
@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Init script of the BOE JD9366 panel, shared by the JD9366 and the
+ * ILI9881C drivers
+ */
+
+#include <linux/build_bug.h>
+#include <linux/export.h>
+#include <linux/kernel.h>
+
+#include "panel-jd9366-init.h"
+
+/*
+ * The JD9366 selects its register pages with a 0xe0 write. The unlock
+ * sequence has to be sent first. Sleep out, display on and TE are
+ * handled by the drivers.
+ */
+const struct panel_init_instr panel_jd9366_init[] = {
+	//Page0
+	PANEL_INIT_SWITCH_PAGE_INSTR(0),
+
+	//--- PASSWORD  ----//
+	PANEL_INIT_COMMAND_INSTR(0xE1, 0x93),
+	PANEL_INIT_COMMAND_INSTR(0xE2, 0x65),
+	PANEL_INIT_COMMAND_INSTR(0xE3, 0xF8),
+
+	//--- Sequence Ctrl  ----//
+	PANEL_INIT_COMMAND_INSTR(0x70, 0x10),	//DC0,DC1
+	PANEL_INIT_COMMAND_INSTR(0x71, 0x13),	//DC2,DC3
+	PANEL_INIT_COMMAND_INSTR(0x72, 0x06),	//DC7
+	PANEL_INIT_COMMAND_INSTR(0x80, 0x03),	//0x03:4-Lane；0x02:3-Lane
+
+	//--- Page4  ----//
+	PANEL_INIT_SWITCH_PAGE_INSTR(4),
+	PANEL_INIT_COMMAND_INSTR(0x2D, 0x03),
+
+	//--- Page1  ----//
+	PANEL_INIT_SWITCH_PAGE_INSTR(1),
+
+	//Set VCOM
+	PANEL_INIT_COMMAND_INSTR(0x00, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x01, 0xA0),
+	//Set VCOM_Reverse
+	PANEL_INIT_COMMAND_INSTR(0x03, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x04, 0xA0),
+
+	//Set Gamma Power, VGMP,VGMN,VGSP,VGSN
+	PANEL_INIT_COMMAND_INSTR(0x17, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x18, 0xB1),
+	PANEL_INIT_COMMAND_INSTR(0x19, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x1A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x1B, 0xB1),  //VGMN=0
+	PANEL_INIT_COMMAND_INSTR(0x1C, 0x01),
+
+	//Set Gate Power
+	PANEL_INIT_COMMAND_INSTR(0x1F, 0x3E),     //VGH_R  = 15V
+	PANEL_INIT_COMMAND_INSTR(0x20, 0x2D),     //VGL_R  = -12V
+	PANEL_INIT_COMMAND_INSTR(0x21, 0x2D),     //VGL_R2 = -12V
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x0E),     //PA[6]=0, PA[5]=0, PA[4]=0, PA[0]=0
+
+	//SETPANEL
+	PANEL_INIT_COMMAND_INSTR(0x37, 0x19),	//SS=1,BGR=1
+
+	//SET RGBCYC
+	PANEL_INIT_COMMAND_INSTR(0x38, 0x05),	//JDT=101 zigzag inversion
+	PANEL_INIT_COMMAND_INSTR(0x39, 0x08),	//RGB_N_EQ1, modify 20140806
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0x12),	//RGB_N_EQ2, modify 20140806
+	PANEL_INIT_COMMAND_INSTR(0x3C, 0x78),	//SET EQ3 for TE_H
+	PANEL_INIT_COMMAND_INSTR(0x3E, 0x80),	//SET CHGEN_OFF, modify 20140806
+	PANEL_INIT_COMMAND_INSTR(0x3F, 0x80),	//SET CHGEN_OFF2, modify 20140806
+
+	//Set TCON
+	PANEL_INIT_COMMAND_INSTR(0x40, 0x06),	//RSO=800 RGB
+	PANEL_INIT_COMMAND_INSTR(0x41, 0xA0),	//LN=640->1280 line
+
+	//--- power voltage  ----//
+	PANEL_INIT_COMMAND_INSTR(0x55, 0x01),	//DCDCM=0001, JD PWR_IC
+	PANEL_INIT_COMMAND_INSTR(0x56, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x57, 0x69),
+	PANEL_INIT_COMMAND_INSTR(0x58, 0x0A),
+	PANEL_INIT_COMMAND_INSTR(0x59, 0x0A),	//VCL = -2.9V
+	PANEL_INIT_COMMAND_INSTR(0x5A, 0x28),	//VGH = 19V
+	PANEL_INIT_COMMAND_INSTR(0x5B, 0x19),	//VGL = -11V
+
+	//--- Gamma  ----//
+	PANEL_INIT_COMMAND_INSTR(0x5D, 0x7C),
+	PANEL_INIT_COMMAND_INSTR(0x5E, 0x65),
+	PANEL_INIT_COMMAND_INSTR(0x5F, 0x53),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x48),
+	PANEL_INIT_COMMAND_INSTR(0x61, 0x43),
+	PANEL_INIT_COMMAND_INSTR(0x62, 0x35),
+	PANEL_INIT_COMMAND_INSTR(0x63, 0x39),
+	PANEL_INIT_COMMAND_INSTR(0x64, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0x65, 0x3D),
+	PANEL_INIT_COMMAND_INSTR(0x66, 0x3C),
+	PANEL_INIT_COMMAND_INSTR(0x67, 0x3D),
+	PANEL_INIT_COMMAND_INSTR(0x68, 0x5A),
+	PANEL_INIT_COMMAND_INSTR(0x69, 0x46),
+	PANEL_INIT_COMMAND_INSTR(0x6A, 0x57),
+	PANEL_INIT_COMMAND_INSTR(0x6B, 0x4B),
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x49),
+	PANEL_INIT_COMMAND_INSTR(0x6D, 0x2F),
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x70, 0x7C),
+	PANEL_INIT_COMMAND_INSTR(0x71, 0x65),
+	PANEL_INIT_COMMAND_INSTR(0x72, 0x53),
+	PANEL_INIT_COMMAND_INSTR(0x73, 0x48),
+	PANEL_INIT_COMMAND_INSTR(0x74, 0x43),
+	PANEL_INIT_COMMAND_INSTR(0x75, 0x35),
+	PANEL_INIT_COMMAND_INSTR(0x76, 0x39),
+	PANEL_INIT_COMMAND_INSTR(0x77, 0x23),
+	PANEL_INIT_COMMAND_INSTR(0x78, 0x3D),
+	PANEL_INIT_COMMAND_INSTR(0x79, 0x3C),
+	PANEL_INIT_COMMAND_INSTR(0x7A, 0x3D),
+	PANEL_INIT_COMMAND_INSTR(0x7B, 0x5A),
+	PANEL_INIT_COMMAND_INSTR(0x7C, 0x46),
+	PANEL_INIT_COMMAND_INSTR(0x7D, 0x57),
+	PANEL_INIT_COMMAND_INSTR(0x7E, 0x4B),
+	PANEL_INIT_COMMAND_INSTR(0x7F, 0x49),
+	PANEL_INIT_COMMAND_INSTR(0x80, 0x2F),
+	PANEL_INIT_COMMAND_INSTR(0x81, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x82, 0x00),
+
+	//Page2, for GIP
+	PANEL_INIT_SWITCH_PAGE_INSTR(2),
+
+	//GIP_L Pin mapping
+	PANEL_INIT_COMMAND_INSTR(0x00, 0x47),
+	PANEL_INIT_COMMAND_INSTR(0x01, 0x47),
+	PANEL_INIT_COMMAND_INSTR(0x02, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0x03, 0x45),
+	PANEL_INIT_COMMAND_INSTR(0x04, 0x4B),
+	PANEL_INIT_COMMAND_INSTR(0x05, 0x4B),
+	PANEL_INIT_COMMAND_INSTR(0x06, 0x49),
+	PANEL_INIT_COMMAND_INSTR(0x07, 0x49),
+	PANEL_INIT_COMMAND_INSTR(0x08, 0x41),
+	PANEL_INIT_COMMAND_INSTR(0x09, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x0A, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x0B, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x0C, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x0D, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x0E, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x0F, 0x43),
+	PANEL_INIT_COMMAND_INSTR(0x10, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x11, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x12, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x13, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x14, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x15, 0x1F),
+
+	//GIP_R Pin mapping
+	PANEL_INIT_COMMAND_INSTR(0x16, 0x46),
+	PANEL_INIT_COMMAND_INSTR(0x17, 0x46),
+	PANEL_INIT_COMMAND_INSTR(0x18, 0x44),
+	PANEL_INIT_COMMAND_INSTR(0x19, 0x44),
+	PANEL_INIT_COMMAND_INSTR(0x1A, 0x4A),
+	PANEL_INIT_COMMAND_INSTR(0x1B, 0x4A),
+	PANEL_INIT_COMMAND_INSTR(0x1C, 0x48),
+	PANEL_INIT_COMMAND_INSTR(0x1D, 0x48),
+	PANEL_INIT_COMMAND_INSTR(0x1E, 0x40),
+	PANEL_INIT_COMMAND_INSTR(0x1F, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x20, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x21, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x22, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x23, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x24, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x25, 0x42),
+	PANEL_INIT_COMMAND_INSTR(0x26, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x27, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x28, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x29, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x2A, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x2B, 0x1F),
+
+	//GIP_L_GS Pin mapping
+	PANEL_INIT_COMMAND_INSTR(0x2C, 0x11),
+	PANEL_INIT_COMMAND_INSTR(0x2D, 0x0F),
+	PANEL_INIT_COMMAND_INSTR(0x2E, 0x0D),
+	PANEL_INIT_COMMAND_INSTR(0x2F, 0x0B),
+	PANEL_INIT_COMMAND_INSTR(0x30, 0x09),
+	PANEL_INIT_COMMAND_INSTR(0x31, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x32, 0x05),
+	PANEL_INIT_COMMAND_INSTR(0x33, 0x18),
+	PANEL_INIT_COMMAND_INSTR(0x34, 0x17),
+	PANEL_INIT_COMMAND_INSTR(0x35, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x36, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x37, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x38, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x39, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x3A, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x3B, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x3C, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x3D, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x3E, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x3F, 0x13),
+	PANEL_INIT_COMMAND_INSTR(0x40, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x41, 0x1F),
+
+	//GIP_R_GS Pin mapping
+	PANEL_INIT_COMMAND_INSTR(0x42, 0x10),
+	PANEL_INIT_COMMAND_INSTR(0x43, 0x0E),
+	PANEL_INIT_COMMAND_INSTR(0x44, 0x0C),
+	PANEL_INIT_COMMAND_INSTR(0x45, 0x0A),
+	PANEL_INIT_COMMAND_INSTR(0x46, 0x08),
+	PANEL_INIT_COMMAND_INSTR(0x47, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x48, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x49, 0x18),
+	PANEL_INIT_COMMAND_INSTR(0x4A, 0x17),
+	PANEL_INIT_COMMAND_INSTR(0x4B, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x4C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x4D, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x4E, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x4F, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x50, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x51, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x52, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x53, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x54, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x55, 0x12),
+	PANEL_INIT_COMMAND_INSTR(0x56, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x57, 0x1F),
+
+	//GIP Timing
+	PANEL_INIT_COMMAND_INSTR(0x58, 0x40),
+	PANEL_INIT_COMMAND_INSTR(0x59, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x5A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x5B, 0x30),
+	PANEL_INIT_COMMAND_INSTR(0x5C, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x5D, 0x30),
+	PANEL_INIT_COMMAND_INSTR(0x5E, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x5F, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x60, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x61, 0x01),
+	PANEL_INIT_COMMAND_INSTR(0x62, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0x63, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x64, 0x6B),
+	PANEL_INIT_COMMAND_INSTR(0x65, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x66, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x67, 0x73),
+	PANEL_INIT_COMMAND_INSTR(0x68, 0x05),
+	PANEL_INIT_COMMAND_INSTR(0x69, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x6A, 0x6B),
+	PANEL_INIT_COMMAND_INSTR(0x6B, 0x08),
+	PANEL_INIT_COMMAND_INSTR(0x6C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x6D, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x6E, 0x04),
+	PANEL_INIT_COMMAND_INSTR(0x6F, 0x88),
+	PANEL_INIT_COMMAND_INSTR(0x70, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x71, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x72, 0x06),
+	PANEL_INIT_COMMAND_INSTR(0x73, 0x7B),
+	PANEL_INIT_COMMAND_INSTR(0x74, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x75, 0x07),
+	PANEL_INIT_COMMAND_INSTR(0x76, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x77, 0x5D),
+	PANEL_INIT_COMMAND_INSTR(0x78, 0x17),
+	PANEL_INIT_COMMAND_INSTR(0x79, 0x1F),
+	PANEL_INIT_COMMAND_INSTR(0x7A, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x7B, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x7C, 0x00),
+	PANEL_INIT_COMMAND_INSTR(0x7D, 0x03),
+	PANEL_INIT_COMMAND_INSTR(0x7E, 0x7B),
+
+	//Page1
+	PANEL_INIT_SWITCH_PAGE_INSTR(1),
+	PANEL_INIT_COMMAND_INSTR(0x0E, 0x01),	//LEDON output VCSW2
+
+	//Page3
+	PANEL_INIT_SWITCH_PAGE_INSTR(3),
+	PANEL_INIT_COMMAND_INSTR(0x98, 0x2F),	//From 2E to 2F, LED_VOL
+
+	//Page4
+	PANEL_INIT_SWITCH_PAGE_INSTR(4),
+	PANEL_INIT_COMMAND_INSTR(0x09, 0x10),
+	PANEL_INIT_COMMAND_INSTR(0x2B, 0x2B),
+	PANEL_INIT_COMMAND_INSTR(0x2E, 0x44),
+
+	//Page0
+	PANEL_INIT_SWITCH_PAGE_INSTR(0),
+	PANEL_INIT_COMMAND_INSTR(0xE6, 0x02),
+	PANEL_INIT_COMMAND_INSTR(0xE7, 0x02),
+};
+static_assert(ARRAY_SIZE(panel_jd9366_init) == PANEL_JD9366_INIT_LENGTH);
+EXPORT_SYMBOL_GPL(panel_jd9366_init);
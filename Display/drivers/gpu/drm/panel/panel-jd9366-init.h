@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Init script of the BOE JD9366 panel
+ */
+
+#ifndef _PANEL_JD9366_INIT_H_
+#define _PANEL_JD9366_INIT_H_
+
+#include "panel-init-script.h"
+
+#define PANEL_JD9366_INIT_LENGTH	218
+
+extern const struct panel_init_instr panel_jd9366_init[];
+
+#endif /* _PANEL_JD9366_INIT_H_ */
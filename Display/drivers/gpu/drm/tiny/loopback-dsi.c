@@ -0,0 +1,505 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Loopback MIPI DSI host
+ *
+ * A DSI host with nothing behind it, to run the panel drivers and the
+ * whole DRM display path without the hardware, in QEMU for instance.
+ * The panel is a child node of the host, as with any DSI host. Once it
+ * attaches, a DRM device is created with one CRTC, the panel bridge and
+ * a DSI connector, so that atomic commits prepare and enable the panel
+ * the same way they do on vc4.
+ *
+ * The transfers go to a register file. DCS writes with a parameter are
+ * stored, per page for the ILI9881C (0xff 0x98 0x81 page) and JD9366
+ * (0xe0 page) page switches, and reads return them. The power mode
+ * register follows the sleep, idle and display on/off commands, and
+ * the ID registers (0xda to 0xdc) return the panel_id parameter. Each
+ * transfer takes transfer_us, plus byte_ns per byte on the link.
+ *
+ * /sys/kernel/debug/loopback-dsi/stats has the transfer counters. They
+ * include the transfers made while the CRTC was off: on vc4 the DSI
+ * block is only powered while the display is on, so these point at a
+ * panel driver racing with the disable path.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/delay.h>
+#include <linux/device.h>
+#include <linux/err.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/seq_file.h>
+
+#include <drm/drm_atomic_helper.h>
+#include <drm/drm_bridge.h>
+#include <drm/drm_drv.h>
+#include <drm/drm_fourcc.h>
+#include <drm/drm_gem_framebuffer_helper.h>
+#include <drm/drm_gem_shmem_helper.h>
+#include <drm/drm_managed.h>
+#include <drm/drm_mipi_dsi.h>
+#include <drm/drm_modeset_helper.h>
+#include <drm/drm_of.h>
+#include <drm/drm_panel.h>
+#include <drm/drm_simple_kms_helper.h>
+#include <drm/drm_vblank.h>
+
+#include <video/mipi_display.h>
+
+#define LOOPBACK_DSI_PAGES	8
+
+static unsigned int transfer_us;
+module_param(transfer_us, uint, 0644);
+MODULE_PARM_DESC(transfer_us, "Time each transfer takes in us");
+
+static unsigned int byte_ns;
+module_param(byte_ns, uint, 0644);
+MODULE_PARM_DESC(byte_ns, "Time each byte takes on the link in ns");
+
+static u8 panel_id[3] = { 0x98, 0x81, 0x0c };
+module_param_array(panel_id, byte, NULL, 0644);
+MODULE_PARM_DESC(panel_id, "Panel ID returned in registers 0xda to 0xdc");
+
+struct loopback_dsi_stats {
+	u64 transfers;
+	u64 reads;
+	u64 bytes;
+	u64 transfer_ns;
+	u64 unlinked;
+	u64 attaches;
+};
+
+struct loopback_dsi {
+	struct device *dev;
+	struct mipi_dsi_host host;
+
+	struct drm_device *drm;
+	struct drm_simple_display_pipe pipe;
+	struct drm_bridge *bridge;
+
+	/* Protects the registers, the link state and the counters */
+	struct mutex lock;
+	u8 regs[LOOPBACK_DSI_PAGES][256];
+	unsigned int page;
+	/* Set while the CRTC is on */
+	bool link;
+	struct loopback_dsi_stats stats;
+
+	struct dentry *debugfs;
+};
+
+static inline struct loopback_dsi *host_to_loopback_dsi(struct mipi_dsi_host *host)
+{
+	return container_of(host, struct loopback_dsi, host);
+}
+
+static inline struct loopback_dsi *pipe_to_loopback_dsi(struct drm_simple_display_pipe *pipe)
+{
+	return container_of(pipe, struct loopback_dsi, pipe);
+}
+
+/* Called with the lock held */
+static void loopback_dsi_reset_regs(struct loopback_dsi *lb)
+{
+	memset(lb->regs, 0, sizeof(lb->regs));
+	lb->page = 0;
+	lb->regs[0][MIPI_DCS_GET_POWER_MODE] = MIPI_DCS_POWER_MODE_NORMAL;
+}
+
+static u8 loopback_dsi_read_reg(struct loopback_dsi *lb, u8 reg)
+{
+	if (!lb->page && reg >= 0xda && reg <= 0xdc)
+		return panel_id[reg - 0xda];
+
+	return lb->regs[lb->page][reg];
+}
+
+static void loopback_dsi_write_regs(struct loopback_dsi *lb, const u8 *tx,
+				    size_t len)
+{
+	u8 *mode = &lb->regs[0][MIPI_DCS_GET_POWER_MODE];
+
+	/* Page switches of the ILI9881C and the JD9366 */
+	if (len == 4 && tx[0] == 0xff && tx[1] == 0x98 && tx[2] == 0x81) {
+		lb->page = tx[3] % LOOPBACK_DSI_PAGES;
+		return;
+	}
+	if (len == 2 && tx[0] == 0xe0) {
+		lb->page = tx[1] % LOOPBACK_DSI_PAGES;
+		return;
+	}
+
+	switch (tx[0]) {
+	case MIPI_DCS_SOFT_RESET:
+		loopback_dsi_reset_regs(lb);
+		return;
+	case MIPI_DCS_EXIT_SLEEP_MODE:
+		*mode |= MIPI_DCS_POWER_MODE_SLEEP;
+		return;
+	case MIPI_DCS_ENTER_SLEEP_MODE:
+		*mode &= ~MIPI_DCS_POWER_MODE_SLEEP;
+		return;
+	case MIPI_DCS_SET_DISPLAY_ON:
+		*mode |= MIPI_DCS_POWER_MODE_DISPLAY;
+		return;
+	case MIPI_DCS_SET_DISPLAY_OFF:
+		*mode &= ~MIPI_DCS_POWER_MODE_DISPLAY;
+		return;
+	case MIPI_DCS_ENTER_IDLE_MODE:
+		*mode |= MIPI_DCS_POWER_MODE_IDLE;
+		return;
+	case MIPI_DCS_EXIT_IDLE_MODE:
+		*mode &= ~MIPI_DCS_POWER_MODE_IDLE;
+		return;
+	}
+
+	if (len >= 2)
+		lb->regs[lb->page][tx[0]] = tx[1];
+}
+
+static ssize_t loopback_dsi_host_transfer(struct mipi_dsi_host *host,
+					  const struct mipi_dsi_msg *msg)
+{
+	struct loopback_dsi *lb = host_to_loopback_dsi(host);
+	struct mipi_dsi_packet packet;
+	const u8 *tx = msg->tx_buf;
+	u8 *rx = msg->rx_buf;
+	u64 start, ns;
+	ssize_t ret;
+	size_t i;
+
+	ret = mipi_dsi_create_packet(&packet, msg);
+	if (ret)
+		return ret;
+
+	start = ktime_get_ns();
+
+	ns = transfer_us * 1000ULL + (packet.size + msg->rx_len) * byte_ns;
+	if (ns >= 10 * NSEC_PER_USEC)
+		usleep_range(ns / 1000, ns / 1000 + ns / 8000 + 1);
+	else if (ns)
+		ndelay(ns);
+
+	mutex_lock(&lb->lock);
+
+	if (!lb->link)
+		lb->stats.unlinked++;
+
+	if (msg->type == MIPI_DSI_SET_MAXIMUM_RETURN_PACKET_SIZE) {
+		ret = msg->tx_len;
+	} else if (msg->rx_len) {
+		u8 reg = msg->tx_len ? tx[0] : 0;
+
+		for (i = 0; i < msg->rx_len; i++)
+			rx[i] = loopback_dsi_read_reg(lb, reg + i);
+		lb->stats.reads++;
+		ret = msg->rx_len;
+	} else {
+		if (msg->tx_len)
+			loopback_dsi_write_regs(lb, tx, msg->tx_len);
+		ret = msg->tx_len;
+	}
+
+	lb->stats.transfers++;
+	lb->stats.bytes += packet.size;
+	lb->stats.transfer_ns += ktime_get_ns() - start;
+
+	mutex_unlock(&lb->lock);
+
+	return ret;
+}
+
+/* No vblank interrupt, a frame is "scanned out" as soon as it's committed */
+static void loopback_dsi_send_event(struct drm_crtc *crtc)
+{
+	struct drm_pending_vblank_event *event = crtc->state->event;
+
+	if (!event)
+		return;
+
+	crtc->state->event = NULL;
+
+	spin_lock_irq(&crtc->dev->event_lock);
+	drm_crtc_send_vblank_event(crtc, event);
+	spin_unlock_irq(&crtc->dev->event_lock);
+}
+
+static void loopback_dsi_pipe_enable(struct drm_simple_display_pipe *pipe,
+				     struct drm_crtc_state *crtc_state,
+				     struct drm_plane_state *plane_state)
+{
+	struct loopback_dsi *lb = pipe_to_loopback_dsi(pipe);
+
+	mutex_lock(&lb->lock);
+	lb->link = true;
+	mutex_unlock(&lb->lock);
+}
+
+static void loopback_dsi_pipe_disable(struct drm_simple_display_pipe *pipe)
+{
+	struct loopback_dsi *lb = pipe_to_loopback_dsi(pipe);
+
+	mutex_lock(&lb->lock);
+	lb->link = false;
+	mutex_unlock(&lb->lock);
+
+	loopback_dsi_send_event(&pipe->crtc);
+}
+
+static void loopback_dsi_pipe_update(struct drm_simple_display_pipe *pipe,
+				     struct drm_plane_state *old_state)
+{
+	loopback_dsi_send_event(&pipe->crtc);
+}
+
+static const struct drm_simple_display_pipe_funcs loopback_dsi_pipe_funcs = {
+	.enable		= loopback_dsi_pipe_enable,
+	.disable	= loopback_dsi_pipe_disable,
+	.update		= loopback_dsi_pipe_update,
+};
+
+static const u32 loopback_dsi_formats[] = {
+	DRM_FORMAT_XRGB8888,
+	DRM_FORMAT_RGB565,
+};
+
+static const struct drm_mode_config_funcs loopback_dsi_mode_config_funcs = {
+	.fb_create	= drm_gem_fb_create,
+	.atomic_check	= drm_atomic_helper_check,
+	.atomic_commit	= drm_atomic_helper_commit,
+};
+
+DEFINE_DRM_GEM_FOPS(loopback_dsi_fops);
+
+static struct drm_driver loopback_dsi_drm_driver = {
+	.driver_features	= DRIVER_MODESET | DRIVER_GEM | DRIVER_ATOMIC,
+	.fops			= &loopback_dsi_fops,
+	DRM_GEM_SHMEM_DRIVER_OPS,
+	.name			= "loopback-dsi",
+	.desc			= "Loopback MIPI DSI host",
+	.date			= "20261018",
+	.major			= 1,
+	.minor			= 0,
+};
+
+static int loopback_dsi_drm_create(struct loopback_dsi *lb,
+				   struct drm_panel *panel)
+{
+	struct drm_device *drm;
+	int ret;
+
+	drm = drm_dev_alloc(&loopback_dsi_drm_driver, lb->dev);
+	if (IS_ERR(drm))
+		return PTR_ERR(drm);
+	drm->dev_private = lb;
+
+	ret = drmm_mode_config_init(drm);
+	if (ret)
+		goto err_put;
+
+	drm->mode_config.min_width = 1;
+	drm->mode_config.min_height = 1;
+	drm->mode_config.max_width = 4096;
+	drm->mode_config.max_height = 4096;
+	drm->mode_config.funcs = &loopback_dsi_mode_config_funcs;
+
+	memset(&lb->pipe, 0, sizeof(lb->pipe));
+	ret = drm_simple_display_pipe_init(drm, &lb->pipe,
+					   &loopback_dsi_pipe_funcs,
+					   loopback_dsi_formats,
+					   ARRAY_SIZE(loopback_dsi_formats),
+					   NULL, NULL);
+	if (ret)
+		goto err_put;
+
+	lb->bridge = drm_panel_bridge_add_typed(panel, DRM_MODE_CONNECTOR_DSI);
+	if (IS_ERR(lb->bridge)) {
+		ret = PTR_ERR(lb->bridge);
+		goto err_put;
+	}
+
+	ret = drm_simple_display_pipe_attach_bridge(&lb->pipe, lb->bridge);
+	if (ret)
+		goto err_bridge;
+
+	drm_mode_config_reset(drm);
+
+	ret = drm_dev_register(drm, 0);
+	if (ret)
+		goto err_bridge;
+
+	lb->drm = drm;
+
+	return 0;
+
+err_bridge:
+	/* The encoder cleanup detaches the bridge */
+	drm_dev_put(drm);
+	drm_panel_bridge_remove(lb->bridge);
+	return ret;
+
+err_put:
+	drm_dev_put(drm);
+	return ret;
+}
+
+static void loopback_dsi_drm_destroy(struct loopback_dsi *lb)
+{
+	if (!lb->drm)
+		return;
+
+	drm_dev_unregister(lb->drm);
+	drm_atomic_helper_shutdown(lb->drm);
+	drm_dev_put(lb->drm);
+	drm_panel_bridge_remove(lb->bridge);
+	lb->drm = NULL;
+}
+
+static int loopback_dsi_host_attach(struct mipi_dsi_host *host,
+				    struct mipi_dsi_device *dsi)
+{
+	struct loopback_dsi *lb = host_to_loopback_dsi(host);
+	struct drm_panel *panel;
+	int ret;
+
+	panel = of_drm_find_panel(dsi->dev.of_node);
+	if (IS_ERR(panel))
+		return PTR_ERR(panel);
+
+	mutex_lock(&lb->lock);
+	loopback_dsi_reset_regs(lb);
+	lb->stats.attaches++;
+	mutex_unlock(&lb->lock);
+
+	ret = loopback_dsi_drm_create(lb, panel);
+	if (ret) {
+		dev_err(lb->dev, "Couldn't create the DRM device: %d\n", ret);
+		return ret;
+	}
+
+	dev_info(lb->dev, "%s attached, %u lanes, mode flags 0x%lx\n",
+		 dev_name(&dsi->dev), dsi->lanes, dsi->mode_flags);
+
+	return 0;
+}
+
+static int loopback_dsi_host_detach(struct mipi_dsi_host *host,
+				    struct mipi_dsi_device *dsi)
+{
+	struct loopback_dsi *lb = host_to_loopback_dsi(host);
+
+	loopback_dsi_drm_destroy(lb);
+
+	return 0;
+}
+
+static const struct mipi_dsi_host_ops loopback_dsi_host_ops = {
+	.attach		= loopback_dsi_host_attach,
+	.detach		= loopback_dsi_host_detach,
+	.transfer	= loopback_dsi_host_transfer,
+};
+
+static int loopback_dsi_stats_show(struct seq_file *m, void *data)
+{
+	struct loopback_dsi *lb = m->private;
+	struct loopback_dsi_stats stats;
+	bool link;
+
+	mutex_lock(&lb->lock);
+	stats = lb->stats;
+	link = lb->link;
+	mutex_unlock(&lb->lock);
+
+	seq_printf(m, "transfers %llu\n", stats.transfers);
+	seq_printf(m, "reads %llu\n", stats.reads);
+	seq_printf(m, "bytes %llu\n", stats.bytes);
+	seq_printf(m, "transfer_ns %llu\n", stats.transfer_ns);
+	seq_printf(m, "unlinked %llu\n", stats.unlinked);
+	seq_printf(m, "attaches %llu\n", stats.attaches);
+	seq_printf(m, "link %d\n", link);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(loopback_dsi_stats);
+
+static int loopback_dsi_probe(struct platform_device *pdev)
+{
+	struct device *dev = &pdev->dev;
+	struct loopback_dsi *lb;
+	int ret;
+
+	lb = devm_kzalloc(dev, sizeof(*lb), GFP_KERNEL);
+	if (!lb)
+		return -ENOMEM;
+
+	lb->dev = dev;
+	mutex_init(&lb->lock);
+	loopback_dsi_reset_regs(lb);
+	platform_set_drvdata(pdev, lb);
+
+	lb->host.dev = dev;
+	lb->host.ops = &loopback_dsi_host_ops;
+	ret = mipi_dsi_host_register(&lb->host);
+	if (ret) {
+		dev_err(dev, "Couldn't register the DSI host: %d\n", ret);
+		return ret;
+	}
+
+	lb->debugfs = debugfs_create_dir("loopback-dsi", NULL);
+	debugfs_create_file("stats", 0444, lb->debugfs, lb,
+			    &loopback_dsi_stats_fops);
+
+	return 0;
+}
+
+static int loopback_dsi_remove(struct platform_device *pdev)
+{
+	struct loopback_dsi *lb = platform_get_drvdata(pdev);
+
+	/* Removes the panel, which detaches and takes the DRM device along */
+	mipi_dsi_host_unregister(&lb->host);
+	debugfs_remove_recursive(lb->debugfs);
+
+	return 0;
+}
+
+static int __maybe_unused loopback_dsi_suspend(struct device *dev)
+{
+	struct loopback_dsi *lb = dev_get_drvdata(dev);
+
+	return lb->drm ? drm_mode_config_helper_suspend(lb->drm) : 0;
+}
+
+static int __maybe_unused loopback_dsi_resume(struct device *dev)
+{
+	struct loopback_dsi *lb = dev_get_drvdata(dev);
+
+	return lb->drm ? drm_mode_config_helper_resume(lb->drm) : 0;
+}
+
+static SIMPLE_DEV_PM_OPS(loopback_dsi_pm_ops, loopback_dsi_suspend,
+			 loopback_dsi_resume);
+
+static const struct of_device_id loopback_dsi_of_match[] = {
+	{ .compatible = "loopback-dsi" },
+	{ }
+};
+MODULE_DEVICE_TABLE(of, loopback_dsi_of_match);
+
+static struct platform_driver loopback_dsi_driver = {
+	.probe	= loopback_dsi_probe,
+	.remove	= loopback_dsi_remove,
+	.driver	= {
+		.name		= "loopback-dsi",
+		.of_match_table	= loopback_dsi_of_match,
+		.pm		= &loopback_dsi_pm_ops,
+	},
+};
+module_platform_driver(loopback_dsi_driver);
+
+MODULE_DESCRIPTION("Loopback MIPI DSI host for testing the panel drivers");
+MODULE_LICENSE("GPL v2");
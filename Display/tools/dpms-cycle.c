@@ -0,0 +1,668 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Display on/off cycle benchmark
+ *
+ * Turns the display off and on again through atomic commits of the
+ * CRTC's ACTIVE property, a number of times, and reports the time of
+ * each commit: on the way up the CRTC enable, the panel prepare() and
+ * enable(), on the way down the reverse. With the loopback DSI host
+ * (drivers/gpu/drm/tiny/loopback-dsi.c) the transfer counters are read
+ * around each commit too, which splits it into the time spent in DSI
+ * transfers and the rest (regulators, GPIOs and the drivers' sleeps),
+ * and counts the transfers made while the CRTC was off.
+ *
+ * --nonblock queues the off and on commits back to back without
+ * waiting, to shake out races between the enable and disable paths of
+ * the panel driver. Only the number of cycles and the transfers made
+ * with the link off are reported then, with the kernel log to check.
+ *
+ * In QEMU:
+ *   modprobe loopback-dsi, with Display/loopback-dsi-overlay.dts applied
+ *   dpms-cycle --count 1000
+ * Nothing else may be driving the display.
+ *
+ * Build: gcc -O2 -Wall $(pkg-config --cflags libdrm) -o dpms-cycle
+ *            dpms-cycle.c $(pkg-config --libs libdrm)
+ * Usage: dpms-cycle [--card DEV] [--connector ID] [--count N]
+ *                   [--on-ms N] [--off-ms N] [--nonblock]
+ *                   [--stats FILE] [--csv FILE]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#define LOOPBACK_STATS	"/sys/kernel/debug/loopback-dsi/stats"
+
+struct display {
+	int fd;
+	uint32_t crtc;
+	uint32_t connector;
+	uint32_t plane;
+	drmModeModeInfo mode;
+	uint32_t mode_blob;
+	uint32_t handle;
+	uint32_t fb;
+
+	uint32_t crtc_active, crtc_mode_id;
+	uint32_t conn_crtc_id;
+	uint32_t plane_fb_id, plane_crtc_id;
+	uint32_t plane_src_w, plane_src_h, plane_crtc_w, plane_crtc_h;
+};
+
+/* Cumulative counters of the loopback DSI host */
+struct link_stats {
+	uint64_t transfers;
+	uint64_t transfer_ns;
+	uint64_t unlinked;
+};
+
+struct sample {
+	double commit_us;
+	double dsi_us;
+	unsigned int transfers;
+};
+
+struct stats {
+	double *v;
+	unsigned int n;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void stats_add(struct stats *s, double v)
+{
+	s->v[s->n++] = v;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void stats_print(const char *name, struct stats *s)
+{
+	double *v = s->v;
+	unsigned int n = s->n;
+
+	if (!n) {
+		printf("%-16s   no samples\n", name);
+		return;
+	}
+
+	qsort(v, n, sizeof(*v), cmp_double);
+	printf("%-16s %7.2f %7.2f %7.2f %7.2f %7.2f\n", name, v[0] / 1e3,
+	       v[n / 2] / 1e3, v[n * 95 / 100] / 1e3, v[n * 99 / 100] / 1e3,
+	       v[n - 1] / 1e3);
+}
+
+static int read_link_stats(const char *path, struct link_stats *s)
+{
+	char key[32];
+	unsigned long long v;
+	FILE *f;
+
+	if (!path)
+		return -1;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+
+	while (fscanf(f, "%31s %llu", key, &v) == 2) {
+		if (!strcmp(key, "transfers"))
+			s->transfers = v;
+		else if (!strcmp(key, "transfer_ns"))
+			s->transfer_ns = v;
+		else if (!strcmp(key, "unlinked"))
+			s->unlinked = v;
+	}
+	fclose(f);
+
+	return 0;
+}
+
+static uint32_t get_prop(int fd, uint32_t id, uint32_t type,
+			 const char *name)
+{
+	drmModeObjectProperties *props;
+	uint32_t prop = 0;
+	uint32_t i;
+
+	props = drmModeObjectGetProperties(fd, id, type);
+	if (!props)
+		return 0;
+
+	for (i = 0; i < props->count_props && !prop; i++) {
+		drmModePropertyRes *p = drmModeGetProperty(fd, props->props[i]);
+
+		if (!p)
+			continue;
+		if (!strcmp(p->name, name))
+			prop = p->prop_id;
+		drmModeFreeProperty(p);
+	}
+	drmModeFreeObjectProperties(props);
+
+	return prop;
+}
+
+/* Prefer a DSI connector, the panel, then anything connected */
+static int pick_connector(struct display *d, drmModeRes *res,
+			  uint32_t wanted)
+{
+	drmModeConnector *best = NULL;
+	int crtc_index = -1;
+	drmModePlaneRes *planes;
+	int i;
+
+	for (i = 0; i < res->count_connectors; i++) {
+		drmModeConnector *c = drmModeGetConnector(d->fd,
+							  res->connectors[i]);
+
+		if (!c)
+			continue;
+
+		if (c->connection != DRM_MODE_CONNECTED || !c->count_modes ||
+		    (wanted && c->connector_id != wanted) ||
+		    (best && (best->connector_type == DRM_MODE_CONNECTOR_DSI ||
+			      c->connector_type != DRM_MODE_CONNECTOR_DSI))) {
+			drmModeFreeConnector(c);
+			continue;
+		}
+
+		if (best)
+			drmModeFreeConnector(best);
+		best = c;
+	}
+
+	if (!best)
+		return -ENODEV;
+
+	d->connector = best->connector_id;
+	d->mode = best->modes[0];
+	for (i = 0; i < best->count_modes; i++)
+		if (best->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+			d->mode = best->modes[i];
+			break;
+		}
+
+	/* Any CRTC the connector's encoders can drive */
+	d->crtc = 0;
+	for (i = 0; i < best->count_encoders && !d->crtc; i++) {
+		drmModeEncoder *e = drmModeGetEncoder(d->fd, best->encoders[i]);
+		int j;
+
+		if (!e)
+			continue;
+
+		for (j = 0; j < res->count_crtcs && !d->crtc; j++)
+			if (e->possible_crtcs & (1 << j)) {
+				d->crtc = res->crtcs[j];
+				crtc_index = j;
+			}
+		drmModeFreeEncoder(e);
+	}
+	drmModeFreeConnector(best);
+
+	if (!d->crtc)
+		return -ENODEV;
+
+	/* The CRTC's primary plane */
+	planes = drmModeGetPlaneResources(d->fd);
+	if (!planes)
+		return -ENODEV;
+
+	d->plane = 0;
+	for (i = 0; i < (int)planes->count_planes && !d->plane; i++) {
+		drmModePlane *p = drmModeGetPlane(d->fd, planes->planes[i]);
+		drmModeObjectProperties *props;
+		uint32_t j;
+
+		if (!p)
+			continue;
+
+		props = (p->possible_crtcs & (1 << crtc_index)) ?
+			drmModeObjectGetProperties(d->fd, p->plane_id,
+						   DRM_MODE_OBJECT_PLANE) : NULL;
+		for (j = 0; props && j < props->count_props; j++) {
+			drmModePropertyRes *prop =
+				drmModeGetProperty(d->fd, props->props[j]);
+
+			if (prop && !strcmp(prop->name, "type") &&
+			    props->prop_values[j] == DRM_PLANE_TYPE_PRIMARY)
+				d->plane = p->plane_id;
+			drmModeFreeProperty(prop);
+		}
+		drmModeFreeObjectProperties(props);
+		drmModeFreePlane(p);
+	}
+	drmModeFreePlaneResources(planes);
+
+	return d->plane ? 0 : -ENODEV;
+}
+
+static int create_fb(struct display *d)
+{
+	struct drm_mode_create_dumb create = {
+		.width = d->mode.hdisplay,
+		.height = d->mode.vdisplay,
+		.bpp = 32,
+	};
+
+	if (drmIoctl(d->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create))
+		return -errno;
+	d->handle = create.handle;
+
+	if (drmModeAddFB(d->fd, d->mode.hdisplay, d->mode.vdisplay, 24, 32,
+			 create.pitch, create.handle, &d->fb))
+		return -errno;
+
+	return 0;
+}
+
+static int open_display(struct display *d, const char *card,
+			uint32_t connector)
+{
+	drmModeRes *res;
+	char path[64];
+	int i, ret;
+
+	for (i = 0; i < 16; i++) {
+		if (card)
+			snprintf(path, sizeof(path), "%s", card);
+		else
+			snprintf(path, sizeof(path), "/dev/dri/card%d", i);
+
+		d->fd = open(path, O_RDWR | O_CLOEXEC);
+		if (d->fd < 0) {
+			if (card)
+				break;
+			continue;
+		}
+
+		if (drmSetClientCap(d->fd, DRM_CLIENT_CAP_ATOMIC, 1)) {
+			ret = -EOPNOTSUPP;
+		} else {
+			res = drmModeGetResources(d->fd);
+			ret = res ? pick_connector(d, res, connector) : -ENODEV;
+			if (res)
+				drmModeFreeResources(res);
+		}
+		if (!ret)
+			break;
+
+		close(d->fd);
+		d->fd = -1;
+		if (card)
+			break;
+	}
+
+	if (d->fd < 0) {
+		fprintf(stderr, "no usable atomic display found\n");
+		return -1;
+	}
+
+	d->crtc_active = get_prop(d->fd, d->crtc, DRM_MODE_OBJECT_CRTC,
+				  "ACTIVE");
+	d->crtc_mode_id = get_prop(d->fd, d->crtc, DRM_MODE_OBJECT_CRTC,
+				   "MODE_ID");
+	d->conn_crtc_id = get_prop(d->fd, d->connector,
+				   DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID");
+	d->plane_fb_id = get_prop(d->fd, d->plane, DRM_MODE_OBJECT_PLANE,
+				  "FB_ID");
+	d->plane_crtc_id = get_prop(d->fd, d->plane, DRM_MODE_OBJECT_PLANE,
+				    "CRTC_ID");
+	d->plane_src_w = get_prop(d->fd, d->plane, DRM_MODE_OBJECT_PLANE,
+				  "SRC_W");
+	d->plane_src_h = get_prop(d->fd, d->plane, DRM_MODE_OBJECT_PLANE,
+				  "SRC_H");
+	d->plane_crtc_w = get_prop(d->fd, d->plane, DRM_MODE_OBJECT_PLANE,
+				   "CRTC_W");
+	d->plane_crtc_h = get_prop(d->fd, d->plane, DRM_MODE_OBJECT_PLANE,
+				   "CRTC_H");
+	if (!d->crtc_active || !d->crtc_mode_id || !d->conn_crtc_id ||
+	    !d->plane_fb_id || !d->plane_crtc_id || !d->plane_src_w ||
+	    !d->plane_src_h || !d->plane_crtc_w || !d->plane_crtc_h) {
+		fprintf(stderr, "missing atomic properties\n");
+		return -1;
+	}
+
+	ret = create_fb(d);
+	if (ret) {
+		fprintf(stderr, "can't create the framebuffer: %s\n",
+			strerror(-ret));
+		return -1;
+	}
+
+	if (drmModeCreatePropertyBlob(d->fd, &d->mode, sizeof(d->mode),
+				      &d->mode_blob)) {
+		fprintf(stderr, "can't create the mode blob: %s\n",
+			strerror(errno));
+		return -1;
+	}
+
+	printf("%s: connector %u, crtc %u, plane %u, %ux%u@%u\n", path,
+	       d->connector, d->crtc, d->plane, d->mode.hdisplay,
+	       d->mode.vdisplay, d->mode.vrefresh);
+
+	return 0;
+}
+
+static void close_display(struct display *d)
+{
+	struct drm_mode_destroy_dumb destroy = { .handle = d->handle };
+
+	if (d->fb)
+		drmModeRmFB(d->fd, d->fb);
+	if (d->handle)
+		drmIoctl(d->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+	if (d->mode_blob)
+		drmModeDestroyPropertyBlob(d->fd, d->mode_blob);
+
+	close(d->fd);
+}
+
+/* The whole pipeline on, or only the CRTC's ACTIVE flag */
+static int commit(struct display *d, int active, int full, uint32_t flags)
+{
+	drmModeAtomicReq *req = drmModeAtomicAlloc();
+	int ret;
+
+	if (!req)
+		return -ENOMEM;
+
+	drmModeAtomicAddProperty(req, d->crtc, d->crtc_active, active);
+	if (full) {
+		drmModeAtomicAddProperty(req, d->crtc, d->crtc_mode_id,
+					 d->mode_blob);
+		drmModeAtomicAddProperty(req, d->connector, d->conn_crtc_id,
+					 d->crtc);
+		drmModeAtomicAddProperty(req, d->plane, d->plane_fb_id, d->fb);
+		drmModeAtomicAddProperty(req, d->plane, d->plane_crtc_id,
+					 d->crtc);
+		drmModeAtomicAddProperty(req, d->plane, d->plane_src_w,
+					 (uint64_t)d->mode.hdisplay << 16);
+		drmModeAtomicAddProperty(req, d->plane, d->plane_src_h,
+					 (uint64_t)d->mode.vdisplay << 16);
+		drmModeAtomicAddProperty(req, d->plane, d->plane_crtc_w,
+					 d->mode.hdisplay);
+		drmModeAtomicAddProperty(req, d->plane, d->plane_crtc_h,
+					 d->mode.vdisplay);
+	}
+
+	ret = drmModeAtomicCommit(d->fd, req,
+				  flags | DRM_MODE_ATOMIC_ALLOW_MODESET, NULL);
+	ret = ret ? -errno : 0;
+	drmModeAtomicFree(req);
+
+	return ret;
+}
+
+/* A blocking commit, timed, with the DSI share if we can see it */
+static int timed_commit(struct display *d, int active, const char *stats,
+			struct sample *s, struct link_stats *link)
+{
+	struct link_stats before = *link;
+	double start;
+	int ret;
+
+	start = now_us();
+	ret = commit(d, active, 0, 0);
+	s->commit_us = now_us() - start;
+	if (ret)
+		return ret;
+
+	if (!read_link_stats(stats, link)) {
+		s->transfers = link->transfers - before.transfers;
+		s->dsi_us = (link->transfer_ns - before.transfer_ns) / 1e3;
+	}
+
+	return 0;
+}
+
+/* Queue a commit, waiting for the previous one to be taken */
+static int queue_commit(struct display *d, int active, unsigned int *busy)
+{
+	int ret;
+
+	while ((ret = commit(d, active, 0, DRM_MODE_ATOMIC_NONBLOCK)) ==
+	       -EBUSY) {
+		(*busy)++;
+		usleep(100);
+	}
+
+	return ret;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [--card DEV] [--connector ID] [--count N] "
+		"[--on-ms N] [--off-ms N] [--nonblock] [--stats FILE] "
+		"[--csv FILE]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{ "card", required_argument, NULL, 'c' },
+		{ "connector", required_argument, NULL, 'C' },
+		{ "count", required_argument, NULL, 'n' },
+		{ "on-ms", required_argument, NULL, 'o' },
+		{ "off-ms", required_argument, NULL, 'f' },
+		{ "nonblock", no_argument, NULL, 'b' },
+		{ "stats", required_argument, NULL, 's' },
+		{ "csv", required_argument, NULL, 'O' },
+		{ "help", no_argument, NULL, 'h' },
+		{ },
+	};
+	struct stats on = { 0 }, on_dsi = { 0 }, on_rest = { 0 };
+	struct stats off = { 0 }, off_dsi = { 0 }, off_rest = { 0 };
+	struct sample *on_samples, *off_samples;
+	struct link_stats link = { 0 }, start_link;
+	struct display d = { .fd = -1 };
+	const char *card = NULL, *csv = NULL, *stats = LOOPBACK_STATS;
+	unsigned int count = 100, on_ms = 0, off_ms = 0, n = 0, busy = 0;
+	unsigned int i;
+	uint32_t connector = 0;
+	int nonblock = 0, have_link, ret = 1;
+	int c;
+
+	while ((c = getopt_long(argc, argv, "c:C:n:o:f:bs:O:h", options,
+				NULL)) != -1) {
+		switch (c) {
+		case 'c':
+			card = optarg;
+			break;
+		case 'C':
+			connector = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		case 'o':
+			on_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			off_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			nonblock = 1;
+			break;
+		case 's':
+			stats = optarg;
+			break;
+		case 'O':
+			csv = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc || !count) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	on_samples = calloc(count, sizeof(*on_samples));
+	off_samples = calloc(count, sizeof(*off_samples));
+	on.v = calloc(count, sizeof(double));
+	on_dsi.v = calloc(count, sizeof(double));
+	on_rest.v = calloc(count, sizeof(double));
+	off.v = calloc(count, sizeof(double));
+	off_dsi.v = calloc(count, sizeof(double));
+	off_rest.v = calloc(count, sizeof(double));
+	if (!on_samples || !off_samples || !on.v || !on_dsi.v ||
+	    !on_rest.v || !off.v || !off_dsi.v || !off_rest.v) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	if (open_display(&d, card, connector))
+		goto out;
+
+	have_link = !read_link_stats(stats, &link);
+	if (!have_link) {
+		printf("%s not found, no DSI breakdown\n", stats);
+		stats = NULL;
+	}
+
+	if (commit(&d, 1, 1, 0)) {
+		fprintf(stderr, "can't turn the display on (is a compositor "
+			"running?): %s\n", strerror(errno));
+		goto out;
+	}
+	read_link_stats(stats, &link);
+	start_link = link;
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	for (n = 0; n < count && !stop; n++) {
+		if (nonblock) {
+			if (queue_commit(&d, 0, &busy) ||
+			    queue_commit(&d, 1, &busy))
+				break;
+			continue;
+		}
+
+		if (on_ms)
+			usleep(on_ms * 1000);
+		if (timed_commit(&d, 0, stats, &off_samples[n], &link))
+			break;
+
+		if (off_ms)
+			usleep(off_ms * 1000);
+		if (timed_commit(&d, 1, stats, &on_samples[n], &link))
+			break;
+	}
+
+	if (n < count && !stop)
+		fprintf(stderr, "cycle %u failed: %s\n", n, strerror(errno));
+
+	/* A blocking commit waits for the queued ones */
+	if (nonblock)
+		commit(&d, 1, 0, 0);
+	read_link_stats(stats, &link);
+
+	printf("%u cycles", n);
+	if (nonblock)
+		printf(", %u commits refused as busy", busy);
+	printf("\n");
+	if (have_link)
+		printf("%llu transfers with the CRTC off\n",
+		       (unsigned long long)(link.unlinked - start_link.unlinked));
+
+	if (!nonblock) {
+		for (i = 0; i < n; i++) {
+			stats_add(&off, off_samples[i].commit_us);
+			stats_add(&on, on_samples[i].commit_us);
+			if (!have_link)
+				continue;
+			stats_add(&off_dsi, off_samples[i].dsi_us);
+			stats_add(&off_rest, off_samples[i].commit_us -
+				  off_samples[i].dsi_us);
+			stats_add(&on_dsi, on_samples[i].dsi_us);
+			stats_add(&on_rest, on_samples[i].commit_us -
+				  on_samples[i].dsi_us);
+		}
+
+		if (n && have_link)
+			printf("%u transfers per off, %u per on\n",
+			       off_samples[0].transfers,
+			       on_samples[0].transfers);
+
+		printf("%-16s %7s %7s %7s %7s %7s (ms)\n", "", "min", "median",
+		       "p95", "p99", "max");
+		stats_print("off commit", &off);
+		if (have_link) {
+			stats_print("  DSI transfers", &off_dsi);
+			stats_print("  rest", &off_rest);
+		}
+		stats_print("on commit", &on);
+		if (have_link) {
+			stats_print("  DSI transfers", &on_dsi);
+			stats_print("  rest", &on_rest);
+		}
+	}
+
+	if (csv && !nonblock) {
+		FILE *f = fopen(csv, "w");
+
+		if (f) {
+			fprintf(f, "off_us,off_dsi_us,off_transfers,"
+				"on_us,on_dsi_us,on_transfers\n");
+			for (i = 0; i < n; i++)
+				fprintf(f, "%.0f,%.0f,%u,%.0f,%.0f,%u\n",
+					off_samples[i].commit_us,
+					off_samples[i].dsi_us,
+					off_samples[i].transfers,
+					on_samples[i].commit_us,
+					on_samples[i].dsi_us,
+					on_samples[i].transfers);
+			fclose(f);
+		} else {
+			fprintf(stderr, "%s: %s\n", csv, strerror(errno));
+		}
+	}
+
+	ret = n == count || stop ? 0 : 1;
+	if (have_link && link.unlinked != start_link.unlinked)
+		ret = 1;
+
+out:
+	if (d.fd >= 0)
+		close_display(&d);
+
+	return ret;
+}
@@ -0,0 +1,360 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Replay a DSI transfer trace recorded by the panel drivers
+ *
+ * The trace comes from /sys/kernel/debug/dsi-trace.<device>/trace, see
+ * drivers/gpu/drm/panel/panel-dsi-trace.h for the format. Each transfer
+ * is re-issued through a mock DSI host that checks the packet and models
+ * how long it should take on the link. The tool then reports the failed
+ * and retried transfers, the timing statistics of the recorded transfers
+ * against the model, and the largest gaps between transfers, which is
+ * where a slow bring-up usually spends its time.
+ *
+ * Build: gcc -O2 -Wall -o dsi-replay dsi-replay.c
+ * Usage: dsi-replay [--dump] [--gaps N] [--lanes N] [--lp-rate BPS]
+ *                   [--hs-rate BPS] trace.bin
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_MAGIC		0x54495344	/* "DSIT" */
+#define TRACE_VERSION		1
+#define TRACE_HEADER_SIZE	24
+#define TRACE_ENTRY_SIZE	40
+#define TRACE_PAYLOAD		16
+
+#define TRACE_LP		(1 << 0)
+#define TRACE_READ		(1 << 1)
+
+/* MIPI_DSI_MODE_LPM in include/drm/drm_mipi_dsi.h */
+#define DSI_MODE_LPM		(1 << 11)
+
+struct transfer {
+	uint32_t seq;
+	int32_t result;
+	uint64_t start_ns;
+	uint32_t duration_ns;
+	uint8_t type;
+	uint8_t flags;
+	uint16_t len;
+	uint8_t payload[TRACE_PAYLOAD];
+
+	/* Filled in by the mock host */
+	double model_us;
+	int retry;
+};
+
+struct mock_host {
+	unsigned int lanes;
+	double lp_rate;		/* bit/s, escape mode on lane 0 */
+	double hs_rate;		/* bit/s per lane */
+	double lp_overhead;	/* us per packet */
+	double hs_overhead;	/* us per packet */
+	/* The last write, to spot retries */
+	const struct transfer *last;
+	unsigned int invalid;
+};
+
+static uint16_t get_le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_le64(const uint8_t *p)
+{
+	return get_le32(p) | (uint64_t)get_le32(p + 4) << 32;
+}
+
+static const char *type_name(uint8_t type)
+{
+	switch (type) {
+	case 0x05:
+		return "dcs-short";
+	case 0x15:
+		return "dcs-short-param";
+	case 0x39:
+		return "dcs-long";
+	case 0x06:
+		return "dcs-read";
+	default:
+		return "unknown";
+	}
+}
+
+/* Bytes on the link: short packets are 4 bytes, long ones 4 + n + 2 */
+static unsigned int wire_bytes(const struct transfer *t)
+{
+	if (t->type == 0x39)
+		return 4 + t->len + 2;
+
+	return 4;
+}
+
+static int check_packet(const struct transfer *t)
+{
+	switch (t->type) {
+	case 0x05:
+		return t->len == 1;
+	case 0x15:
+		return t->len == 2;
+	case 0x39:
+		return t->len > 2;
+	case 0x06:
+		return (t->flags & TRACE_READ) != 0;
+	default:
+		return 0;
+	}
+}
+
+static void mock_transfer(struct mock_host *host, struct transfer *t)
+{
+	double bits = wire_bytes(t) * 8.0;
+
+	if (!check_packet(t))
+		host->invalid++;
+
+	if (t->flags & TRACE_LP)
+		t->model_us = bits / host->lp_rate * 1e6 + host->lp_overhead;
+	else
+		t->model_us = bits / (host->hs_rate * host->lanes) * 1e6 +
+			      host->hs_overhead;
+
+	/* Reads need a bus turnaround and the answer from the panel */
+	if (t->flags & TRACE_READ)
+		t->model_us += 2 * (32.0 / host->lp_rate * 1e6) +
+			       host->lp_overhead;
+
+	if (host->last && host->last->result < 0 &&
+	    host->last->type == t->type && host->last->len == t->len &&
+	    !memcmp(host->last->payload, t->payload, sizeof(t->payload)))
+		t->retry = 1;
+
+	host->last = t;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void dump(const struct transfer *t, uint64_t t0)
+{
+	unsigned int i, n = t->len < TRACE_PAYLOAD ? t->len : TRACE_PAYLOAD;
+
+	printf("%6u %10.3f ms %8.1f us  %s %-15s %3d ", t->seq,
+	       (t->start_ns - t0) / 1e6, t->duration_ns / 1e3,
+	       t->flags & TRACE_LP ? "LP" : "HS", type_name(t->type),
+	       t->result);
+	for (i = 0; i < n; i++)
+		printf(" %02x", t->payload[i]);
+	if (n < t->len)
+		printf(" ... (%u bytes)", t->len);
+	printf("%s\n", t->retry ? "  [retry]" : "");
+}
+
+struct gap {
+	uint64_t ns;
+	unsigned int after;
+};
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [--dump] [--gaps N] [--lanes N] [--lp-rate BPS] "
+		"[--hs-rate BPS] trace.bin\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{ "dump", no_argument, NULL, 'd' },
+		{ "gaps", required_argument, NULL, 'g' },
+		{ "lanes", required_argument, NULL, 'l' },
+		{ "lp-rate", required_argument, NULL, 'L' },
+		{ "hs-rate", required_argument, NULL, 'H' },
+		{ "help", no_argument, NULL, 'h' },
+		{ },
+	};
+	struct mock_host host = {
+		.lp_rate = 10e6,
+		.hs_rate = 432e6,
+		.lp_overhead = 10,
+		.hs_overhead = 2,
+	};
+	unsigned int count, lost, entry_size, mode_flags, i, ngaps = 5;
+	unsigned int failed = 0, retries = 0, lanes = 0;
+	uint8_t hdr[TRACE_HEADER_SIZE];
+	double model_total = 0, measured_total = 0;
+	struct transfer *t;
+	struct gap *gaps;
+	uint32_t *durations;
+	int do_dump = 0;
+	FILE *f;
+	int c;
+
+	while ((c = getopt_long(argc, argv, "dg:l:L:H:h", options, NULL)) != -1) {
+		switch (c) {
+		case 'd':
+			do_dump = 1;
+			break;
+		case 'g':
+			ngaps = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			lanes = strtoul(optarg, NULL, 0);
+			break;
+		case 'L':
+			host.lp_rate = strtod(optarg, NULL);
+			break;
+		case 'H':
+			host.hs_rate = strtod(optarg, NULL);
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc - 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	f = fopen(argv[optind], "rb");
+	if (!f) {
+		fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+		return 1;
+	}
+
+	if (fread(hdr, sizeof(hdr), 1, f) != 1 ||
+	    get_le32(hdr) != TRACE_MAGIC) {
+		fprintf(stderr, "%s: not a DSI trace\n", argv[optind]);
+		return 1;
+	}
+
+	if (get_le16(hdr + 4) != TRACE_VERSION) {
+		fprintf(stderr, "%s: unsupported version %u\n", argv[optind],
+			get_le16(hdr + 4));
+		return 1;
+	}
+
+	entry_size = get_le16(hdr + 6);
+	count = get_le32(hdr + 8);
+	lost = get_le32(hdr + 12);
+	host.lanes = lanes ? lanes : get_le32(hdr + 16);
+	mode_flags = get_le32(hdr + 20);
+
+	if (entry_size < TRACE_ENTRY_SIZE || !host.lanes) {
+		fprintf(stderr, "%s: corrupted header\n", argv[optind]);
+		return 1;
+	}
+
+	t = calloc(count ? count : 1, sizeof(*t));
+	durations = calloc(count ? count : 1, sizeof(*durations));
+	gaps = calloc(count ? count : 1, sizeof(*gaps));
+	if (!t || !durations || !gaps) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	for (i = 0; i < count; i++) {
+		uint8_t buf[256];
+
+		if (entry_size > sizeof(buf) ||
+		    fread(buf, entry_size, 1, f) != 1) {
+			fprintf(stderr, "%s: truncated after %u transfers\n",
+				argv[optind], i);
+			count = i;
+			break;
+		}
+
+		t[i].seq = get_le32(buf);
+		t[i].result = (int32_t)get_le32(buf + 4);
+		t[i].start_ns = get_le64(buf + 8);
+		t[i].duration_ns = get_le32(buf + 16);
+		t[i].type = buf[20];
+		t[i].flags = buf[21];
+		t[i].len = get_le16(buf + 22);
+		memcpy(t[i].payload, buf + 24, TRACE_PAYLOAD);
+	}
+	fclose(f);
+
+	printf("%u transfers, %u lost, %u lanes, %s mode\n", count, lost,
+	       host.lanes, mode_flags & DSI_MODE_LPM ? "LP" : "HS");
+	if (!count)
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		mock_transfer(&host, &t[i]);
+
+		if (t[i].result < 0)
+			failed++;
+		retries += t[i].retry;
+		durations[i] = t[i].duration_ns;
+		model_total += t[i].model_us;
+		measured_total += t[i].duration_ns / 1e3;
+
+		if (i) {
+			uint64_t end = t[i - 1].start_ns + t[i - 1].duration_ns;
+
+			gaps[i].ns = t[i].start_ns > end ? t[i].start_ns - end : 0;
+			gaps[i].after = i - 1;
+		}
+
+		if (do_dump)
+			dump(&t[i], t[0].start_ns);
+	}
+
+	qsort(durations, count, sizeof(*durations), cmp_u32);
+
+	printf("span %.3f ms, %.3f ms in transfers (model %.3f ms, x%.1f)\n",
+	       (t[count - 1].start_ns + t[count - 1].duration_ns -
+		t[0].start_ns) / 1e6,
+	       measured_total / 1e3, model_total / 1e3,
+	       model_total > 0 ? measured_total / model_total : 0);
+	printf("transfer time: min %.1f us, median %.1f us, p95 %.1f us, "
+	       "max %.1f us\n", durations[0] / 1e3,
+	       durations[count / 2] / 1e3, durations[count * 95 / 100] / 1e3,
+	       durations[count - 1] / 1e3);
+	printf("%u failed, %u retried, %u invalid packets\n", failed, retries,
+	       host.invalid);
+
+	for (i = 0; i < count; i++)
+		if (t[i].result < 0) {
+			printf("failed: ");
+			dump(&t[i], t[0].start_ns);
+		}
+
+	/* Largest gaps first, gaps[0] is unused */
+	for (i = 0; i < ngaps && i + 1 < count; i++) {
+		unsigned int j, max = 1;
+
+		for (j = 2; j < count; j++)
+			if (gaps[j].ns > gaps[max].ns)
+				max = j;
+		if (!gaps[max].ns)
+			break;
+
+		printf("gap %.3f ms after ", gaps[max].ns / 1e6);
+		dump(&t[gaps[max].after], t[0].start_ns);
+		gaps[max].ns = 0;
+	}
+
+	free(gaps);
+	free(durations);
+	free(t);
+
+	return failed ? 2 : 0;
+}
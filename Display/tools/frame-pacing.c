@@ -0,0 +1,661 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Frame pacing and scanout timing monitor
+ *
+ * Records the vblank timestamps of the panel's CRTC and reports the
+ * actual refresh rate against the nominal one of the mode (pixel clock
+ * over htotal * vtotal), how much it drifts, the jitter of the vblank
+ * intervals and a histogram of them.
+ *
+ * By default it only listens: it asks for a vblank event on every
+ * vblank, without becoming DRM master, so it runs next to the
+ * compositor. That measures the scanout timing. Vblanks that were not
+ * observed because the tool itself was late are counted apart and
+ * don't affect the results.
+ *
+ * --flip takes over the display instead and page flips on every vblank,
+ * optionally after --work-us of busy work to stand in for rendering.
+ * The flip completion events then give the frame times and the number
+ * of vblanks missed, i.e. a frame shown for more than one refresh,
+ * without a compositor in the way.
+ *
+ * Build: gcc -O2 -Wall $(pkg-config --cflags libdrm) -o frame-pacing
+ *            frame-pacing.c $(pkg-config --libs libdrm) -lm
+ * Usage: frame-pacing [--card DEV] [--connector ID] [--count N]
+ *                     [--flip] [--work-us N] [--bin-us N] [--csv FILE]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#define HISTOGRAM_WIDTH	50
+
+struct buffer {
+	uint32_t handle;
+	uint32_t fb;
+};
+
+struct display {
+	int fd;
+	uint32_t crtc;
+	int crtc_index;
+	uint32_t connector;
+	drmModeModeInfo mode;
+	drmModeCrtc *saved;
+	struct buffer buf[2];
+	int front;
+};
+
+struct sample {
+	unsigned int seq;
+	double t_us;
+};
+
+struct recorder {
+	struct display *d;
+	struct sample *samples;
+	unsigned int n, count;
+	int flip;
+	unsigned int work_us;
+	int error;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static double nominal_hz(const drmModeModeInfo *m)
+{
+	double hz = m->clock * 1e3 / ((double)m->htotal * m->vtotal);
+
+	if (m->flags & DRM_MODE_FLAG_INTERLACE)
+		hz *= 2;
+	if (m->flags & DRM_MODE_FLAG_DBLSCAN)
+		hz /= 2;
+
+	return hz;
+}
+
+/* Prefer a DSI connector, the panel, then anything connected */
+static int pick_connector(struct display *d, drmModeRes *res,
+			  uint32_t wanted)
+{
+	drmModeConnector *best = NULL;
+	int i;
+
+	for (i = 0; i < res->count_connectors; i++) {
+		drmModeConnector *c = drmModeGetConnector(d->fd,
+							  res->connectors[i]);
+
+		if (!c)
+			continue;
+
+		if (c->connection != DRM_MODE_CONNECTED || !c->count_modes ||
+		    (wanted && c->connector_id != wanted) ||
+		    (best && (best->connector_type == DRM_MODE_CONNECTOR_DSI ||
+			      c->connector_type != DRM_MODE_CONNECTOR_DSI))) {
+			drmModeFreeConnector(c);
+			continue;
+		}
+
+		if (best)
+			drmModeFreeConnector(best);
+		best = c;
+	}
+
+	if (!best)
+		return -ENODEV;
+
+	d->connector = best->connector_id;
+	d->mode = best->modes[0];
+	for (i = 0; i < best->count_modes; i++)
+		if (best->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+			d->mode = best->modes[i];
+			break;
+		}
+
+	/* The CRTC driving it, or any its encoders can drive */
+	d->crtc = 0;
+	for (i = 0; i < best->count_encoders && !d->crtc; i++) {
+		drmModeEncoder *e = drmModeGetEncoder(d->fd, best->encoders[i]);
+		int j;
+
+		if (!e)
+			continue;
+
+		if (e->crtc_id)
+			d->crtc = e->crtc_id;
+		for (j = 0; j < res->count_crtcs && !d->crtc; j++)
+			if (e->possible_crtcs & (1 << j))
+				d->crtc = res->crtcs[j];
+		drmModeFreeEncoder(e);
+	}
+	drmModeFreeConnector(best);
+
+	for (i = 0; i < res->count_crtcs; i++)
+		if (res->crtcs[i] == d->crtc)
+			d->crtc_index = i;
+
+	return d->crtc ? 0 : -ENODEV;
+}
+
+static int create_buffer(struct display *d, struct buffer *b)
+{
+	struct drm_mode_create_dumb create = {
+		.width = d->mode.hdisplay,
+		.height = d->mode.vdisplay,
+		.bpp = 32,
+	};
+
+	if (drmIoctl(d->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create))
+		return -errno;
+	b->handle = create.handle;
+
+	if (drmModeAddFB(d->fd, d->mode.hdisplay, d->mode.vdisplay, 24, 32,
+			 create.pitch, create.handle, &b->fb))
+		return -errno;
+
+	return 0;
+}
+
+static void destroy_buffer(struct display *d, struct buffer *b)
+{
+	struct drm_mode_destroy_dumb destroy = { .handle = b->handle };
+
+	if (b->fb)
+		drmModeRmFB(d->fd, b->fb);
+	if (b->handle)
+		drmIoctl(d->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+}
+
+static int open_display(struct display *d, const char *card,
+			uint32_t connector, int flip)
+{
+	uint64_t cap = 0;
+	drmModeRes *res;
+	drmModeCrtc *crtc;
+	char path[64];
+	int i, ret;
+
+	for (i = 0; i < 16; i++) {
+		if (card)
+			snprintf(path, sizeof(path), "%s", card);
+		else
+			snprintf(path, sizeof(path), "/dev/dri/card%d", i);
+
+		d->fd = open(path, O_RDWR | O_CLOEXEC);
+		if (d->fd < 0) {
+			if (card)
+				break;
+			continue;
+		}
+
+		res = drmModeGetResources(d->fd);
+		ret = res ? pick_connector(d, res, connector) : -ENODEV;
+		if (res)
+			drmModeFreeResources(res);
+		if (!ret)
+			break;
+
+		close(d->fd);
+		d->fd = -1;
+		if (card)
+			break;
+	}
+
+	if (d->fd < 0) {
+		fprintf(stderr, "no usable display found\n");
+		return -1;
+	}
+
+	if (drmGetCap(d->fd, DRM_CAP_TIMESTAMP_MONOTONIC, &cap) || !cap)
+		fprintf(stderr, "warning: the vblank timestamps aren't "
+			"monotonic, the results are meaningless\n");
+
+	if (!flip) {
+		/* Listen to whatever the CRTC is showing */
+		crtc = drmModeGetCrtc(d->fd, d->crtc);
+		if (!crtc || !crtc->mode_valid) {
+			fprintf(stderr, "crtc %u is off\n", d->crtc);
+			drmModeFreeCrtc(crtc);
+			return -1;
+		}
+		d->mode = crtc->mode;
+		drmModeFreeCrtc(crtc);
+	} else {
+		for (i = 0; i < 2; i++) {
+			ret = create_buffer(d, &d->buf[i]);
+			if (ret) {
+				fprintf(stderr, "can't create the buffers: "
+					"%s\n", strerror(-ret));
+				return -1;
+			}
+		}
+
+		d->saved = drmModeGetCrtc(d->fd, d->crtc);
+
+		if (drmModeSetCrtc(d->fd, d->crtc, d->buf[0].fb, 0, 0,
+				   &d->connector, 1, &d->mode)) {
+			fprintf(stderr, "can't set the mode (is a compositor "
+				"running?): %s\n", strerror(errno));
+			return -1;
+		}
+	}
+
+	printf("%s: connector %u, crtc %u, %ux%u, %u kHz, %ux%u total\n",
+	       path, d->connector, d->crtc, d->mode.hdisplay,
+	       d->mode.vdisplay, d->mode.clock, d->mode.htotal,
+	       d->mode.vtotal);
+
+	return 0;
+}
+
+static void close_display(struct display *d)
+{
+	int i;
+
+	if (d->saved) {
+		drmModeSetCrtc(d->fd, d->saved->crtc_id, d->saved->buffer_id,
+			       d->saved->x, d->saved->y, &d->connector, 1,
+			       &d->saved->mode);
+		drmModeFreeCrtc(d->saved);
+	}
+
+	for (i = 0; i < 2; i++)
+		destroy_buffer(d, &d->buf[i]);
+
+	close(d->fd);
+}
+
+static unsigned int crtc_bits(const struct display *d)
+{
+	if (d->crtc_index == 0)
+		return 0;
+	if (d->crtc_index == 1)
+		return DRM_VBLANK_SECONDARY;
+
+	return (d->crtc_index << DRM_VBLANK_HIGH_CRTC_SHIFT) &
+	       DRM_VBLANK_HIGH_CRTC_MASK;
+}
+
+static int request_vblank(struct recorder *r)
+{
+	drmVBlank vbl = {
+		.request = {
+			.type = DRM_VBLANK_RELATIVE | DRM_VBLANK_EVENT |
+				crtc_bits(r->d),
+			.sequence = 1,
+			.signal = (unsigned long)r,
+		},
+	};
+
+	return drmWaitVBlank(r->d->fd, &vbl) ? -errno : 0;
+}
+
+static int request_flip(struct recorder *r)
+{
+	struct display *d = r->d;
+	double until;
+
+	/* Stand-in for rendering the next frame */
+	if (r->work_us) {
+		until = now_us() + r->work_us;
+		while (now_us() < until)
+			;
+	}
+
+	if (drmModePageFlip(d->fd, d->crtc, d->buf[!d->front].fb,
+			    DRM_MODE_PAGE_FLIP_EVENT, r))
+		return -errno;
+
+	return 0;
+}
+
+static void record(struct recorder *r, unsigned int seq, unsigned int sec,
+		   unsigned int usec)
+{
+	if (r->n < r->count) {
+		r->samples[r->n].seq = seq;
+		r->samples[r->n].t_us = sec * 1e6 + usec;
+		r->n++;
+	}
+}
+
+static void vblank_handler(int fd, unsigned int seq, unsigned int sec,
+			   unsigned int usec, void *data)
+{
+	struct recorder *r = data;
+
+	(void)fd;
+
+	record(r, seq, sec, usec);
+	if (r->n < r->count && !stop)
+		r->error = request_vblank(r);
+}
+
+static void page_flip_handler(int fd, unsigned int seq, unsigned int sec,
+			      unsigned int usec, void *data)
+{
+	struct recorder *r = data;
+
+	(void)fd;
+
+	r->d->front = !r->d->front;
+	record(r, seq, sec, usec);
+	if (r->n < r->count && !stop)
+		r->error = request_flip(r);
+}
+
+/* Least squares fit of t = a + b * seq over samples [from, to) */
+static double fit(const struct sample *s, unsigned int from, unsigned int to,
+		  double *a)
+{
+	double n = to - from, sx = 0, sy = 0, sxx = 0, sxy = 0, x, y, b;
+	unsigned int i;
+
+	for (i = from; i < to; i++) {
+		x = (double)(s[i].seq - s[from].seq);
+		y = s[i].t_us - s[from].t_us;
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+	if (a)
+		*a = (sy - b * sx) / n;
+
+	return b;
+}
+
+static void histogram(const double *v, unsigned int n, double bin_us)
+{
+	unsigned int *bins, nbins, i, max = 0;
+	long first, last;
+	int clamped = 0;
+
+	first = (long)floor(v[0] / bin_us);
+	last = (long)floor(v[n - 1] / bin_us);
+	nbins = last - first + 1;
+	/* A far outlier would make an endless histogram, the last bin takes it */
+	if (nbins > 200) {
+		nbins = 200;
+		clamped = 1;
+	}
+
+	bins = calloc(nbins, sizeof(*bins));
+	if (!bins)
+		return;
+
+	for (i = 0; i < n; i++) {
+		long b = (long)floor(v[i] / bin_us) - first;
+
+		if (b >= (long)nbins)
+			b = nbins - 1;
+		bins[b]++;
+		if (bins[b] > max)
+			max = bins[b];
+	}
+
+	for (i = 0; i < nbins; i++) {
+		unsigned int w = (bins[i] * HISTOGRAM_WIDTH + max - 1) / max;
+
+		if (!bins[i])
+			continue;
+		printf("  %9.3f ms%s %7u ", (first + i) * bin_us / 1e3,
+		       clamped && i == nbins - 1 ? "+" : " ", bins[i]);
+		while (w--)
+			putchar('#');
+		putchar('\n');
+	}
+
+	free(bins);
+}
+
+static void report(const struct recorder *r, double nominal, double bin_us)
+{
+	const struct sample *s = r->samples;
+	unsigned int i, n = r->n, late = 0, missed = 0, half;
+	double period, a, measured, *intervals, *dev, resid, lo = 0, hi = 0;
+	double rms = 0;
+
+	if (n < 4) {
+		printf("only %u vblanks recorded\n", n);
+		return;
+	}
+
+	intervals = calloc(n, sizeof(*intervals));
+	dev = calloc(n, sizeof(*dev));
+	if (!intervals || !dev) {
+		free(intervals);
+		free(dev);
+		return;
+	}
+
+	period = fit(s, 0, n, &a);
+	measured = 1e6 / period;
+
+	for (i = 1; i < n; i++) {
+		unsigned int dseq = s[i].seq - s[i - 1].seq;
+		double dt = s[i].t_us - s[i - 1].t_us;
+		double refresh = dt / (dseq ? dseq : 1);
+
+		if (dseq > 1) {
+			if (r->flip)
+				missed += dseq - 1;
+			else
+				late += dseq - 1;
+		}
+
+		/* Frame times for flips, refresh periods when listening */
+		intervals[i - 1] = r->flip ? dt : refresh;
+		dev[i - 1] = fabs(refresh - period);
+		rms += dev[i - 1] * dev[i - 1];
+
+		resid = s[i].t_us - s[0].t_us - a -
+			period * (double)(s[i].seq - s[0].seq);
+		if (resid < lo)
+			lo = resid;
+		if (resid > hi)
+			hi = resid;
+	}
+	rms = sqrt(rms / (n - 1));
+
+	printf("%u vblanks over %.1f s (sequence %u to %u)\n", n,
+	       (s[n - 1].t_us - s[0].t_us) / 1e6, s[0].seq, s[n - 1].seq);
+	printf("refresh: nominal %.4f Hz, measured %.4f Hz (%+.0f ppm)\n",
+	       nominal, measured, (measured / nominal - 1) * 1e6);
+
+	half = n / 2;
+	printf("drift: first half %.4f Hz, second half %.4f Hz, "
+	       "phase wander %.1f us\n", 1e6 / fit(s, 0, half, NULL),
+	       1e6 / fit(s, half, n, NULL), hi - lo);
+
+	qsort(dev, n - 1, sizeof(*dev), cmp_double);
+	printf("jitter: rms %.1f us, p99 %.1f us, max %.1f us\n", rms,
+	       dev[(n - 1) * 99 / 100], dev[n - 2]);
+
+	if (r->flip)
+		printf("missed vblanks: %u in %u flips\n", missed, n);
+	else
+		printf("vblanks not observed (the tool was late): %u\n", late);
+
+	qsort(intervals, n - 1, sizeof(*intervals), cmp_double);
+	printf("%s, %.0f us bins:\n", r->flip ? "frame times" :
+	       "refresh periods", bin_us);
+	histogram(intervals, n - 1, bin_us);
+
+	free(intervals);
+	free(dev);
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [--card DEV] [--connector ID] [--count N] "
+		"[--flip] [--work-us N] [--bin-us N] [--csv FILE]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{ "card", required_argument, NULL, 'c' },
+		{ "connector", required_argument, NULL, 'C' },
+		{ "count", required_argument, NULL, 'n' },
+		{ "flip", no_argument, NULL, 'f' },
+		{ "work-us", required_argument, NULL, 'w' },
+		{ "bin-us", required_argument, NULL, 'b' },
+		{ "csv", required_argument, NULL, 'o' },
+		{ "help", no_argument, NULL, 'h' },
+		{ },
+	};
+	drmEventContext evctx = {
+		.version = 2,
+		.vblank_handler = vblank_handler,
+		.page_flip_handler = page_flip_handler,
+	};
+	struct display d = { .fd = -1 };
+	struct recorder r = { .d = &d, .count = 1800 };
+	const char *card = NULL, *csv = NULL;
+	uint32_t connector = 0;
+	double bin_us = 50;
+	unsigned int i;
+	int ret = 1;
+	int c;
+
+	while ((c = getopt_long(argc, argv, "c:C:n:fw:b:o:h", options,
+				NULL)) != -1) {
+		switch (c) {
+		case 'c':
+			card = optarg;
+			break;
+		case 'C':
+			connector = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			r.count = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			r.flip = 1;
+			break;
+		case 'w':
+			r.work_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			bin_us = strtod(optarg, NULL);
+			break;
+		case 'o':
+			csv = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc || r.count < 4 || bin_us <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	r.samples = calloc(r.count, sizeof(*r.samples));
+	if (!r.samples) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	if (open_display(&d, card, connector, r.flip))
+		goto out;
+
+	printf("%s %u vblanks\n", r.flip ? "flipping for" : "listening to",
+	       r.count);
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	r.error = r.flip ? request_flip(&r) : request_vblank(&r);
+
+	while (!stop && !r.error && r.n < r.count) {
+		struct pollfd pfd = { .fd = d.fd, .events = POLLIN };
+
+		if (poll(&pfd, 1, 1000) <= 0) {
+			if (!stop)
+				fprintf(stderr, "no vblank for 1 s, is the "
+					"display on?\n");
+			break;
+		}
+		drmHandleEvent(d.fd, &evctx);
+	}
+
+	if (r.error)
+		fprintf(stderr, "%s failed: %s\n", r.flip ? "page flip" :
+			"vblank request", strerror(-r.error));
+
+	/* Let the last flip land before restoring the CRTC */
+	if (r.flip) {
+		struct pollfd pfd = { .fd = d.fd, .events = POLLIN };
+
+		r.count = r.n;
+		if (poll(&pfd, 1, 100) > 0)
+			drmHandleEvent(d.fd, &evctx);
+	}
+
+	report(&r, nominal_hz(&d.mode), bin_us);
+
+	if (csv) {
+		FILE *f = fopen(csv, "w");
+
+		if (f) {
+			fprintf(f, "seq,t_us\n");
+			for (i = 0; i < r.n; i++)
+				fprintf(f, "%u,%.0f\n", r.samples[i].seq,
+					r.samples[i].t_us);
+			fclose(f);
+		} else {
+			fprintf(stderr, "%s: %s\n", csv, strerror(errno));
+		}
+	}
+
+	ret = r.n >= 4 ? 0 : 1;
+
+out:
+	if (d.fd >= 0)
+		close_display(&d);
+
+	return ret;
+}
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+#
+# Build a configuration blob for the GT9271 touch controller.
+#
+# On probe the goodix driver looks for /lib/firmware/goodix_<id>_cfg.bin
+# (goodix_9271_cfg.bin here) and writes it to the controller. The blob
+# is the 184 bytes of configuration registers starting at 0x8047, an
+# 8-bit two's complement checksum and the Config_Fresh flag, which the
+# driver requires to be set.
+#
+# The panel vendor doesn't ship a reference configuration, so this starts
+# from the one that is in the controller, read over I2C with i2ctransfer
+# or from a previous dump, and only changes the requested fields. The
+# config version is left alone: the controller ignores a configuration
+# older than the one it has.
+#
+# Usage: goodix-cfg.py (--bus N | --input FILE) [--report-ms N]
+#                      [--show] [--output FILE]
+
+import argparse
+import subprocess
+import sys
+
+ADDR = 0x5d
+CONFIG_REG = 0x8047
+CONFIG_LEN = 184
+
+# Offsets in the configuration
+VERSION = 0x8047 - CONFIG_REG
+X_MAX = 0x8048 - CONFIG_REG
+Y_MAX = 0x804a - CONFIG_REG
+TOUCHES = 0x804c - CONFIG_REG
+REFRESH_RATE = 0x8056 - CONFIG_REG
+
+# The report period is 5 + N ms, N in the low nibble of Refresh_Rate
+REPORT_MS_MIN = 5
+REPORT_MS_MAX = 5 + 15
+
+
+def read_bus(bus):
+    """Read the configuration straight from the controller."""
+    cmd = ['i2ctransfer', '-f', '-y', str(bus),
+           'w2@0x%02x' % ADDR, '0x%02x' % (CONFIG_REG >> 8),
+           '0x%02x' % (CONFIG_REG & 0xff), 'r%d' % (CONFIG_LEN + 2)]
+    out = subprocess.run(cmd, check=True, capture_output=True,
+                         text=True).stdout
+    return bytes(int(b, 16) for b in out.split())
+
+
+def checksum(cfg):
+    return (~sum(cfg[:CONFIG_LEN]) + 1) & 0xff
+
+
+def show(cfg):
+    print('config version 0x%02x (%c)' % (cfg[VERSION], cfg[VERSION]))
+    print('resolution %dx%d, %d touches'
+          % (cfg[X_MAX] | cfg[X_MAX + 1] << 8,
+             cfg[Y_MAX] | cfg[Y_MAX + 1] << 8, cfg[TOUCHES] & 0x0f))
+    print('report period %d ms' % (5 + (cfg[REFRESH_RATE] & 0x0f)))
+    print('checksum 0x%02x (%s)' % (cfg[CONFIG_LEN],
+                                    'ok' if cfg[CONFIG_LEN] == checksum(cfg)
+                                    else 'bad, expected 0x%02x'
+                                    % checksum(cfg)))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Build a goodix_9271_cfg.bin for the GT9271')
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument('--bus', type=int,
+                     help='read the configuration from this I2C bus')
+    src.add_argument('--input', help='start from this configuration dump')
+    parser.add_argument('--report-ms', type=int,
+                        help='touch report period, %d to %d ms'
+                        % (REPORT_MS_MIN, REPORT_MS_MAX))
+    parser.add_argument('--show', action='store_true',
+                        help='print the resulting configuration')
+    parser.add_argument('--output', help='where to write the blob')
+    args = parser.parse_args()
+
+    if args.bus is not None:
+        cfg = read_bus(args.bus)
+    else:
+        cfg = open(args.input, 'rb').read()
+
+    if len(cfg) < CONFIG_LEN:
+        print('configuration too short: %d bytes' % len(cfg),
+              file=sys.stderr)
+        return 1
+    cfg = bytearray(cfg[:CONFIG_LEN] + bytes(2))
+
+    if args.report_ms is not None:
+        if not REPORT_MS_MIN <= args.report_ms <= REPORT_MS_MAX:
+            print('the report period must be between %d and %d ms'
+                  % (REPORT_MS_MIN, REPORT_MS_MAX), file=sys.stderr)
+            return 1
+        cfg[REFRESH_RATE] = (cfg[REFRESH_RATE] & 0xf0) | \
+            (args.report_ms - REPORT_MS_MIN)
+
+    cfg[CONFIG_LEN] = checksum(cfg)
+    cfg[CONFIG_LEN + 1] = 1     # Config_Fresh
+
+    if args.show or not args.output:
+        show(cfg)
+
+    if args.output:
+        open(args.output, 'wb').write(cfg)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
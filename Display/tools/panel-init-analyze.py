@@ -0,0 +1,379 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+#
+# Static analyzer for the panel init scripts.
+#
+# The scripts are read straight from the driver sources, so whatever is
+# reported here is what the drivers send to the panel. For each script
+# this reports redundant and overwritten register writes, page switches
+# that don't change anything, runs of consecutive registers that could be
+# sent as a single write on controllers that auto-increment the register
+# address, and the modeled time it takes to send the script on the DSI
+# link in LP and HS mode. The delays the drivers wait around the script,
+# power up and reset pulse plus reset settle time before and sleep out
+# after, are read from the drivers and reported along, once per panel
+# description using the script.
+#
+# Nothing is assumed about the page selected when a script starts, so the
+# first page switch is never reported as a no-op.
+#
+# Usage: panel-init-analyze.py [--dump] [--panel NAME] [driver.c ...]
+
+import argparse
+import os
+import re
+import sys
+
+PANEL_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                         '..', 'drivers', 'gpu', 'drm', 'panel')
+
+# DCS commands that change the power state of the panel, the drivers
+# send these themselves with the right delays
+POWER_CMDS = {
+    0x10: 'enter_sleep_mode',
+    0x11: 'exit_sleep_mode',
+    0x28: 'set_display_off',
+    0x29: 'set_display_on',
+    0x34: 'set_tear_off',
+    0x35: 'set_tear_on',
+}
+
+
+class Op:
+    """One step of an init script: a page switch, a write or a delay."""
+
+    def __init__(self, kind, line, page=None, payload=None, ms=0, why=None):
+        self.kind = kind          # 'page', 'write' or 'sleep'
+        self.line = line
+        self.page = page
+        self.payload = payload or []
+        self.ms = ms
+        self.why = why
+
+    @property
+    def reg(self):
+        return self.payload[0]
+
+    def wire_bytes(self, page_cmd_len):
+        """Size of the DSI packet carrying this op, header and CRC included."""
+        if self.kind == 'page':
+            n = page_cmd_len
+        elif self.kind == 'write':
+            n = len(self.payload)
+        else:
+            return 0
+        # DCS short writes carry up to two bytes in the header, anything
+        # longer is a long packet with a 2 bytes checksum
+        return 4 if n <= 2 else 4 + n + 2
+
+
+class Script:
+    def __init__(self, name, source, page_cmd_len):
+        self.name = name
+        self.source = source
+        self.page_cmd_len = page_cmd_len
+        self.ops = []
+        # Panel description the delays were taken from
+        self.desc = None
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', lambda m: '\n' * m.group(0).count('\n'),
+                  text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def line_of(text, pos):
+    return text.count('\n', 0, pos) + 1
+
+
+def ints(args):
+    return [int(a, 0) for a in args.replace(' ', '').split(',') if a]
+
+
+def parse_tables(path, page_cmd_len):
+    """Tables of struct panel_init_instr, see panel-init-script.h."""
+    text = strip_comments(open(path).read())
+    scripts = []
+
+    for m in re.finditer(r'(?:static )?const struct panel_init_instr (\w+)\[\]'
+                         r'\s*=\s*\{(.*?)\n\};', text, re.S):
+        name = m.group(1)
+        script = Script(name, path, page_cmd_len(name))
+
+        for i in re.finditer(r'PANEL_INIT_(SWITCH_PAGE|COMMAND)_INSTR'
+                             r'\(([^)]*)\)', m.group(2)):
+            line = line_of(text, m.start(2) + i.start())
+            args = ints(i.group(2))
+            if i.group(1) == 'SWITCH_PAGE':
+                script.ops.append(Op('page', line, page=args[0]))
+            else:
+                script.ops.append(Op('write', line, payload=args))
+
+        scripts.append(script)
+
+    return scripts
+
+
+def parse_defines(text):
+    return {m.group(1): int(m.group(2), 0) for m in
+            re.finditer(r'#define\s+(\w+)\s+(\d+)\b', text)}
+
+
+def parse_descs(text, struct):
+    """Initializers of struct <struct>, as name -> {field: value}."""
+    descs = {}
+    for m in re.finditer(r'static const struct %s (\w+) = \{(.*?)\n\};'
+                         % struct, text, re.S):
+        descs[m.group(1)] = dict(re.findall(r'\.(\w+)\s*=\s*(\w+)',
+                                            m.group(2)))
+    return descs
+
+
+def delays_ili9881c(path):
+    """(init, desc, reset, settle, sleep out) of the ILI9881C descriptions."""
+    text = strip_comments(open(path).read())
+    defines = parse_defines(text)
+    for name, fields in parse_descs(text, 'ili9881c_desc').items():
+        # A zero settle time means the default, see struct ili9881c_desc
+        settle = int(fields.get('reset_settle_ms', '0'), 0) or \
+            defines['ILI9881C_RESET_SETTLE_MS']
+        yield (fields['init'], name,
+               defines['ILI9881C_POWER_UP_MS'] + defines['ILI9881C_RESET_MS'],
+               settle, defines['ILI9881C_SLEEP_OUT_MS'])
+
+
+def delays_jd9366(path):
+    """(init, desc, reset, settle, sleep out) of the JD9366 descriptions."""
+    text = strip_comments(open(path).read())
+    for name, fields in parse_descs(text, 'jd9366_desc').items():
+        # Display on is sent and waited for by prepare() as well
+        yield (fields['init'], name, int(fields['reset_ms'], 0),
+               int(fields['reset_settle_ms'], 0),
+               int(fields['sleep_out_ms'], 0) +
+               int(fields['display_on_ms'], 0))
+
+
+DELAYS = {
+    'panel-ilitek-ili9881c.c': delays_ili9881c,
+    'panel-jd9366.c': delays_jd9366,
+}
+
+
+def parse_delays(files):
+    """Map of init script name -> [(desc, reset, settle, sleep out)]."""
+    paths = {os.path.basename(f): f for f in files}
+    for base in DELAYS:
+        if base not in paths and os.path.exists(os.path.join(PANEL_DIR, base)):
+            paths[base] = os.path.join(PANEL_DIR, base)
+
+    delays = {}
+    for base, path in sorted(paths.items()):
+        if base in DELAYS:
+            for init, *desc_delays in DELAYS[base](path):
+                delays.setdefault(init, []).append(tuple(desc_delays))
+    return delays
+
+
+def with_delays(script, delays):
+    """One copy of the script per description, wrapped in its delays."""
+    if script.name not in delays:
+        return [script]
+
+    scripts = []
+    for desc, reset, settle, sleep_out in delays[script.name]:
+        s = Script(script.name, script.source, script.page_cmd_len)
+        s.desc = desc
+        s.ops = [Op('sleep', None, ms=reset, why='power up and reset pulse'),
+                 Op('sleep', None, ms=settle, why='reset settle')] + \
+            script.ops + [Op('sleep', None, ms=sleep_out, why='sleep out')]
+        scripts.append(s)
+    return scripts
+
+
+def parse_file(path):
+    base = os.path.basename(path)
+    if base == 'panel-ilitek-ili9881c.c':
+        return parse_tables(path, lambda name: 4)
+    if base == 'panel-jd9366-init.c':
+        # The JD9366 selects its pages with a single 0xe0 write
+        return parse_tables(path, lambda name: 2)
+    return []
+
+
+def page_name(page):
+    """The page, or '?' before the script's first page switch."""
+    return '?' if page is None else '%d' % page
+
+
+def analyze(script):
+    """Return a list of (line, message) findings."""
+    findings = []
+    page = None         # whatever the panel had selected
+    last = {}           # (page, reg) -> (value, line)
+    prev = None
+
+    for op in script.ops:
+        if op.kind == 'sleep':
+            continue
+        if op.kind == 'page':
+            if op.page == page:
+                findings.append((op.line, 'page switch to page %d is a no-op'
+                                 % op.page))
+            elif prev is not None and prev.kind == 'page':
+                findings.append((prev.line, 'page %d selected but never used'
+                                 % prev.page))
+            page = op.page
+        elif op.kind == 'write':
+            key = (page, op.reg)
+            if page == 0 and op.reg in POWER_CMDS:
+                findings.append((op.line, '%s (0x%02x) belongs to the driver'
+                                 % (POWER_CMDS[op.reg], op.reg)))
+            if key in last:
+                value, line = last[key]
+                if value == op.payload[1:]:
+                    findings.append((op.line, 'page %s reg 0x%02x rewritten '
+                                     'with the same value (line %d)'
+                                     % (page_name(page), op.reg, line)))
+                else:
+                    findings.append((line, 'page %s reg 0x%02x overwritten '
+                                     'at line %d' % (page_name(page), op.reg,
+                                                     op.line)))
+            last[key] = (op.payload[1:], op.line)
+        prev = op
+
+    return findings
+
+
+def mergeable_runs(script, min_len):
+    """Runs of single byte writes to consecutive registers of a page."""
+    runs = []
+    page = None
+    run = []
+
+    def flush():
+        if len(run) >= min_len:
+            runs.append((page, run[0].reg, run[-1].reg, len(run), run[0].line))
+
+    for op in script.ops:
+        if op.kind == 'write' and len(op.payload) == 2 and run and \
+           op.reg == run[-1].reg + 1:
+            run.append(op)
+            continue
+
+        flush()
+        run = []
+        if op.kind == 'page':
+            page = op.page
+        elif op.kind == 'write' and len(op.payload) == 2:
+            run = [op]
+    flush()
+
+    return runs
+
+
+def link_time_us(script, args):
+    """Modeled time to send the script in LP and HS mode, in microseconds."""
+    packets = [op.wire_bytes(script.page_cmd_len) for op in script.ops
+               if op.kind != 'sleep']
+    total = sum(packets)
+
+    # In LP mode everything goes on lane 0 in escape mode
+    lp = total * 8 / args.lp_rate * 1e6 + len(packets) * args.lp_overhead
+    # In HS mode the packets are spread over the lanes
+    hs = total * 8 / (args.hs_rate * args.lanes) * 1e6 + \
+        len(packets) * args.hs_overhead
+
+    return len(packets), total, lp, hs
+
+
+def dump(script):
+    page = None
+    for op in script.ops:
+        if op.kind == 'page':
+            page = op.page
+            print('  %5d  page %d' % (op.line, page))
+        elif op.kind == 'write':
+            print('  %5d    [%s] %s' % (op.line, page_name(page),
+                                        ' '.join('%02x' % b for b in op.payload)))
+        else:
+            print('         msleep(%d), %s' % (op.ms, op.why))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Analyze the panel init scripts of the DRM panel drivers")
+    parser.add_argument('files', nargs='*',
+                        help='driver sources (default: all panel drivers)')
+    parser.add_argument('--panel', help='only report this init script')
+    parser.add_argument('--dump', action='store_true',
+                        help='print the decoded init scripts')
+    parser.add_argument('--min-run', type=int, default=4,
+                        help='shortest register run reported as mergeable')
+    parser.add_argument('--lanes', type=int, default=4)
+    parser.add_argument('--lp-rate', type=float, default=10e6,
+                        help='LP escape mode bit rate (bit/s)')
+    parser.add_argument('--lp-overhead', type=float, default=10,
+                        help='per packet LP overhead (us)')
+    parser.add_argument('--hs-rate', type=float, default=432e6,
+                        help='HS bit rate per lane (bit/s)')
+    parser.add_argument('--hs-overhead', type=float, default=2,
+                        help='per packet HS overhead (us)')
+    args = parser.parse_args()
+
+    files = args.files or sorted(
+        os.path.join(PANEL_DIR, f) for f in
+        ('panel-ilitek-ili9881c.c', 'panel-jd9366-init.c')
+        if os.path.exists(os.path.join(PANEL_DIR, f)))
+
+    delays = parse_delays(files)
+    scripts = []
+    for f in files:
+        for s in parse_file(f):
+            scripts += with_delays(s, delays)
+    if args.panel:
+        scripts = [s for s in scripts if s.name == args.panel]
+    if not scripts:
+        print('no init script found', file=sys.stderr)
+        return 1
+
+    reported = set()
+    for s in scripts:
+        writes = sum(1 for op in s.ops if op.kind == 'write')
+        pages = sum(1 for op in s.ops if op.kind == 'page')
+        sleep = sum(op.ms for op in s.ops if op.kind == 'sleep')
+        count, size, lp, hs = link_time_us(s, args)
+
+        if s.desc:
+            print('%s (%s, %s)' % (s.name, os.path.basename(s.source),
+                                   s.desc))
+        else:
+            print('%s (%s)' % (s.name, os.path.basename(s.source)))
+        print('  %d writes, %d page switches, %d bytes on the link'
+              % (writes, pages, size))
+        print('  modeled transfer time: LP %.2f ms, HS %.2f ms, sleeps %d ms'
+              % (lp / 1000, hs / 1000, sleep))
+
+        if args.dump:
+            dump(s)
+
+        # The findings are about the table, whoever uses it
+        if s.name in reported:
+            print()
+            continue
+        reported.add(s.name)
+
+        for line, msg in analyze(s):
+            print('  line %d: %s' % (line, msg))
+
+        for page, first, last, n, line in mergeable_runs(s, args.min_run):
+            print('  line %d: page %s regs 0x%02x-0x%02x (%d writes) could '
+                  'be a single write' % (line, page_name(page), first, last,
+                                         n))
+        print()
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,855 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Touch to photon latency benchmark
+ *
+ * Takes over the display, draws a marker under each touch and flips it
+ * to the screen, then correlates the evdev timestamp of the touch with
+ * the timestamp of the vblank that put the marker on screen. The marker
+ * row is only lit once the scanout reaches it, so that time is added
+ * to get the photon time; the liquid crystal response of the panel is
+ * not included.
+ *
+ * Reported, each as a distribution:
+ *   report interval  time between two touch reports while touching
+ *   event to submit  touch event to page flip request, the app's share
+ *   submit to flip   page flip request to the vblank that scanned it out
+ *   event to photon  touch event to the scanout of the marker row
+ *
+ * Off-device, --uinput injects taps from a virtual touchscreen at random
+ * vblank phases, and any DRM device will do for the display, e.g. vkms
+ * ("modprobe vkms"). Nothing else may be driving the display.
+ *
+ * Build: gcc -O2 -Wall $(pkg-config --cflags libdrm) -o touch-latency
+ *            touch-latency.c $(pkg-config --libs libdrm)
+ * Usage: touch-latency [--input DEV] [--card DEV] [--connector ID]
+ *                      [--count N] [--uinput] [--rate HZ] [--csv FILE]
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#define MARKER_SIZE	64
+
+/* How long a synthetic tap stays down */
+#define TAP_MS		20
+
+struct buffer {
+	uint32_t handle;
+	uint32_t fb;
+	uint32_t pitch;
+	uint64_t size;
+	uint8_t *map;
+	/* Marker drawn in this buffer, to erase it on the next use */
+	int marker_x, marker_y;
+	int has_marker;
+};
+
+struct display {
+	int fd;
+	uint32_t crtc;
+	uint32_t connector;
+	drmModeModeInfo mode;
+	drmModeCrtc *saved;
+	struct buffer buf[2];
+	int front;
+	int flip_pending;
+};
+
+struct sample {
+	double event_us;
+	double submit_us;
+	double flip_us;
+	double photon_us;
+	int x, y;
+};
+
+struct stats {
+	double *v;
+	unsigned int n;
+};
+
+struct touch {
+	int down;
+	int x, y;
+	int min_x, max_x, min_y, max_y;
+	/* A touch down was seen since the last report */
+	int pressed;
+	double pressed_us;
+	double last_report_us;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void stats_add(struct stats *s, double v)
+{
+	s->v[s->n++] = v;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void stats_print(const char *name, struct stats *s)
+{
+	double *v = s->v;
+	unsigned int n = s->n;
+
+	if (!n) {
+		printf("%-16s   no samples\n", name);
+		return;
+	}
+
+	qsort(v, n, sizeof(*v), cmp_double);
+	printf("%-16s %7.2f %7.2f %7.2f %7.2f %7.2f\n", name, v[0] / 1e3,
+	       v[n / 2] / 1e3, v[n * 95 / 100] / 1e3, v[n * 99 / 100] / 1e3,
+	       v[n - 1] / 1e3);
+}
+
+static int has_bit(const unsigned long *bits, unsigned int bit)
+{
+	unsigned int n = 8 * sizeof(*bits);
+
+	return (bits[bit / n] >> (bit % n)) & 1;
+}
+
+/* The first device reporting touches with absolute coordinates */
+static int find_touchscreen(char *path, size_t len)
+{
+	struct dirent *d;
+	DIR *dir;
+	int found = 0;
+
+	dir = opendir("/dev/input");
+	if (!dir)
+		return -errno;
+
+	while (!found && (d = readdir(dir))) {
+		unsigned long keys[KEY_MAX / (8 * sizeof(long)) + 1] = { 0 };
+		unsigned long abs[ABS_MAX / (8 * sizeof(long)) + 1] = { 0 };
+		char p[300];
+		int fd;
+
+		if (strncmp(d->d_name, "event", 5))
+			continue;
+
+		snprintf(p, sizeof(p), "/dev/input/%s", d->d_name);
+		fd = open(p, O_RDONLY);
+		if (fd < 0)
+			continue;
+
+		if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) >= 0 &&
+		    ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs)), abs) >= 0 &&
+		    has_bit(keys, BTN_TOUCH) && has_bit(abs, ABS_X) &&
+		    has_bit(abs, ABS_Y)) {
+			snprintf(path, len, "%s", p);
+			found = 1;
+		}
+		close(fd);
+	}
+	closedir(dir);
+
+	return found ? 0 : -ENODEV;
+}
+
+static int open_input(const char *path, struct touch *touch)
+{
+	struct input_absinfo abs;
+	int clock = CLOCK_MONOTONIC;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_NONBLOCK);
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	/* Same clock as the DRM timestamps */
+	if (ioctl(fd, EVIOCSCLOCKID, &clock)) {
+		fprintf(stderr, "%s: can't use the monotonic clock: %s\n",
+			path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	if (ioctl(fd, EVIOCGABS(ABS_X), &abs) >= 0) {
+		touch->min_x = abs.minimum;
+		touch->max_x = abs.maximum;
+	}
+	if (ioctl(fd, EVIOCGABS(ABS_Y), &abs) >= 0) {
+		touch->min_y = abs.minimum;
+		touch->max_y = abs.maximum;
+	}
+
+	if (touch->max_x <= touch->min_x || touch->max_y <= touch->min_y) {
+		fprintf(stderr, "%s: no usable ABS_X/ABS_Y range\n", path);
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static int find_event_node(const char *name, char *path, size_t len)
+{
+	char sys[128];
+	struct dirent *d;
+	DIR *dir;
+	int ret = -ENOENT;
+
+	snprintf(sys, sizeof(sys), "/sys/devices/virtual/input/%s", name);
+	dir = opendir(sys);
+	if (!dir)
+		return -errno;
+
+	while ((d = readdir(dir)))
+		if (!strncmp(d->d_name, "event", 5)) {
+			snprintf(path, len, "/dev/input/%s", d->d_name);
+			ret = 0;
+			break;
+		}
+	closedir(dir);
+
+	return ret;
+}
+
+/*
+ * A virtual touchscreen, for running without the GT9271. Returns the
+ * uinput file descriptor and the path of its event device.
+ */
+static int create_uinput(char *path, size_t len)
+{
+	struct uinput_setup setup = {
+		.id = { .bustype = BUS_VIRTUAL, .vendor = 0x1, .product = 0x1 },
+		.name = "touch-latency virtual touchscreen",
+	};
+	struct uinput_abs_setup abs = {
+		.absinfo = { .minimum = 0, .maximum = 4095 },
+	};
+	char name[64];
+	int fd;
+
+	fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+	if (fd < 0) {
+		fprintf(stderr, "/dev/uinput: %s\n", strerror(errno));
+		return -1;
+	}
+
+	ioctl(fd, UI_SET_EVBIT, EV_KEY);
+	ioctl(fd, UI_SET_KEYBIT, BTN_TOUCH);
+	ioctl(fd, UI_SET_EVBIT, EV_ABS);
+	ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_DIRECT);
+
+	abs.code = ABS_X;
+	ioctl(fd, UI_ABS_SETUP, &abs);
+	abs.code = ABS_Y;
+	ioctl(fd, UI_ABS_SETUP, &abs);
+
+	if (ioctl(fd, UI_DEV_SETUP, &setup) || ioctl(fd, UI_DEV_CREATE)) {
+		fprintf(stderr, "can't create the uinput device: %s\n",
+			strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	if (ioctl(fd, UI_GET_SYSNAME(sizeof(name)), name) < 0) {
+		fprintf(stderr, "can't find the uinput device: %s\n",
+			strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	/* Give udev a chance to create the node */
+	for (int i = 0; i < 50; i++) {
+		if (!find_event_node(name, path, len) && !access(path, R_OK))
+			return fd;
+		usleep(20000);
+	}
+
+	fprintf(stderr, "no event device for %s\n", name);
+	close(fd);
+	return -1;
+}
+
+static void emit(int fd, int type, int code, int value)
+{
+	struct input_event ev = { .type = type, .code = code, .value = value };
+
+	if (write(fd, &ev, sizeof(ev)) != sizeof(ev))
+		_exit(1);
+}
+
+/*
+ * Runs in a child process. The delays are randomized so that the taps
+ * land on every phase of the vblank period.
+ */
+static void inject_taps(int fd, unsigned int count, double rate)
+{
+	unsigned int i;
+
+	srand(getpid());
+
+	for (i = 0; i < count; i++) {
+		double period = 1e6 / rate;
+
+		usleep(period / 2 + rand() % (int)(period / 2 + 1));
+
+		emit(fd, EV_ABS, ABS_X, rand() % 4096);
+		emit(fd, EV_ABS, ABS_Y, rand() % 4096);
+		emit(fd, EV_KEY, BTN_TOUCH, 1);
+		emit(fd, EV_SYN, SYN_REPORT, 0);
+
+		usleep(TAP_MS * 1000);
+
+		emit(fd, EV_KEY, BTN_TOUCH, 0);
+		emit(fd, EV_SYN, SYN_REPORT, 0);
+	}
+
+	_exit(0);
+}
+
+static int create_buffer(struct display *d, struct buffer *b)
+{
+	struct drm_mode_create_dumb create = {
+		.width = d->mode.hdisplay,
+		.height = d->mode.vdisplay,
+		.bpp = 32,
+	};
+	struct drm_mode_map_dumb map = { 0 };
+
+	if (drmIoctl(d->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create))
+		return -errno;
+
+	b->handle = create.handle;
+	b->pitch = create.pitch;
+	b->size = create.size;
+
+	if (drmModeAddFB(d->fd, d->mode.hdisplay, d->mode.vdisplay, 24, 32,
+			 b->pitch, b->handle, &b->fb))
+		return -errno;
+
+	map.handle = b->handle;
+	if (drmIoctl(d->fd, DRM_IOCTL_MODE_MAP_DUMB, &map))
+		return -errno;
+
+	b->map = mmap(NULL, b->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		      d->fd, map.offset);
+	if (b->map == MAP_FAILED)
+		return -errno;
+
+	memset(b->map, 0, b->size);
+
+	return 0;
+}
+
+static void destroy_buffer(struct display *d, struct buffer *b)
+{
+	struct drm_mode_destroy_dumb destroy = { .handle = b->handle };
+
+	if (b->map && b->map != MAP_FAILED)
+		munmap(b->map, b->size);
+	if (b->fb)
+		drmModeRmFB(d->fd, b->fb);
+	if (b->handle)
+		drmIoctl(d->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+}
+
+/* Prefer a DSI connector, the panel, then anything connected */
+static int pick_connector(struct display *d, drmModeRes *res,
+			  uint32_t wanted)
+{
+	drmModeConnector *best = NULL;
+	int i;
+
+	for (i = 0; i < res->count_connectors; i++) {
+		drmModeConnector *c = drmModeGetConnector(d->fd,
+							  res->connectors[i]);
+
+		if (!c)
+			continue;
+
+		if (c->connection != DRM_MODE_CONNECTED || !c->count_modes ||
+		    (wanted && c->connector_id != wanted) ||
+		    (best && (best->connector_type == DRM_MODE_CONNECTOR_DSI ||
+			      c->connector_type != DRM_MODE_CONNECTOR_DSI))) {
+			drmModeFreeConnector(c);
+			continue;
+		}
+
+		if (best)
+			drmModeFreeConnector(best);
+		best = c;
+	}
+
+	if (!best)
+		return -ENODEV;
+
+	d->connector = best->connector_id;
+	d->mode = best->modes[0];
+	for (i = 0; i < best->count_modes; i++)
+		if (best->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+			d->mode = best->modes[i];
+			break;
+		}
+
+	/* Any CRTC the connector's encoders can drive */
+	d->crtc = 0;
+	for (i = 0; i < best->count_encoders && !d->crtc; i++) {
+		drmModeEncoder *e = drmModeGetEncoder(d->fd, best->encoders[i]);
+		int j;
+
+		if (!e)
+			continue;
+
+		if (e->crtc_id)
+			d->crtc = e->crtc_id;
+		for (j = 0; j < res->count_crtcs && !d->crtc; j++)
+			if (e->possible_crtcs & (1 << j))
+				d->crtc = res->crtcs[j];
+		drmModeFreeEncoder(e);
+	}
+	drmModeFreeConnector(best);
+
+	return d->crtc ? 0 : -ENODEV;
+}
+
+static int open_display(struct display *d, const char *card,
+			uint32_t connector)
+{
+	uint64_t cap = 0;
+	drmModeRes *res;
+	char path[64];
+	int i, ret;
+
+	for (i = 0; i < 16; i++) {
+		if (card)
+			snprintf(path, sizeof(path), "%s", card);
+		else
+			snprintf(path, sizeof(path), "/dev/dri/card%d", i);
+
+		d->fd = open(path, O_RDWR | O_CLOEXEC);
+		if (d->fd < 0) {
+			if (card)
+				break;
+			continue;
+		}
+
+		res = drmModeGetResources(d->fd);
+		ret = res ? pick_connector(d, res, connector) : -ENODEV;
+		if (res)
+			drmModeFreeResources(res);
+		if (!ret)
+			break;
+
+		close(d->fd);
+		d->fd = -1;
+		if (card)
+			break;
+	}
+
+	if (d->fd < 0) {
+		fprintf(stderr, "no usable display found\n");
+		return -1;
+	}
+
+	if (drmGetCap(d->fd, DRM_CAP_TIMESTAMP_MONOTONIC, &cap) || !cap)
+		fprintf(stderr, "warning: the vblank timestamps aren't "
+			"monotonic, the results are meaningless\n");
+
+	for (i = 0; i < 2; i++) {
+		ret = create_buffer(d, &d->buf[i]);
+		if (ret) {
+			fprintf(stderr, "can't create the buffers: %s\n",
+				strerror(-ret));
+			return -1;
+		}
+	}
+
+	d->saved = drmModeGetCrtc(d->fd, d->crtc);
+
+	if (drmModeSetCrtc(d->fd, d->crtc, d->buf[0].fb, 0, 0, &d->connector,
+			   1, &d->mode)) {
+		fprintf(stderr, "can't set the mode (is a compositor "
+			"running?): %s\n", strerror(errno));
+		return -1;
+	}
+
+	printf("%s: connector %u, crtc %u, %ux%u@%u\n", path, d->connector,
+	       d->crtc, d->mode.hdisplay, d->mode.vdisplay, d->mode.vrefresh);
+
+	return 0;
+}
+
+static void close_display(struct display *d)
+{
+	int i;
+
+	if (d->saved) {
+		drmModeSetCrtc(d->fd, d->saved->crtc_id, d->saved->buffer_id,
+			       d->saved->x, d->saved->y, &d->connector, 1,
+			       &d->saved->mode);
+		drmModeFreeCrtc(d->saved);
+	}
+
+	for (i = 0; i < 2; i++)
+		destroy_buffer(d, &d->buf[i]);
+
+	close(d->fd);
+}
+
+static void fill(struct buffer *b, int x, int y, uint32_t color,
+		 const drmModeModeInfo *mode)
+{
+	int i, j;
+
+	for (j = y; j < y + MARKER_SIZE && j < mode->vdisplay; j++) {
+		uint32_t *row = (uint32_t *)(b->map + j * b->pitch);
+
+		for (i = x; i < x + MARKER_SIZE && i < mode->hdisplay; i++)
+			row[i] = color;
+	}
+}
+
+static int submit(struct display *d, struct sample *s)
+{
+	struct buffer *b = &d->buf[!d->front];
+	int x = s->x - MARKER_SIZE / 2, y = s->y - MARKER_SIZE / 2;
+
+	x = x < 0 ? 0 : x;
+	y = y < 0 ? 0 : y;
+
+	if (b->has_marker)
+		fill(b, b->marker_x, b->marker_y, 0x000000, &d->mode);
+	fill(b, x, y, 0xffffff, &d->mode);
+	b->marker_x = x;
+	b->marker_y = y;
+	b->has_marker = 1;
+
+	s->submit_us = now_us();
+	if (drmModePageFlip(d->fd, d->crtc, b->fb, DRM_MODE_PAGE_FLIP_EVENT,
+			    s)) {
+		fprintf(stderr, "page flip failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	d->flip_pending = 1;
+
+	return 0;
+}
+
+struct flip_ctx {
+	struct display *d;
+	struct sample *done;
+};
+
+static struct flip_ctx flip_ctx;
+
+static void page_flip_handler(int fd, unsigned int frame, unsigned int sec,
+			      unsigned int usec, void *data)
+{
+	struct display *d = flip_ctx.d;
+	struct sample *s = data;
+	double line_us = d->mode.htotal * 1e3 / d->mode.clock;
+
+	(void)fd;
+	(void)frame;
+
+	/* The timestamp is the start of the scanout of the first line */
+	s->flip_us = sec * 1e6 + usec;
+	s->photon_us = s->flip_us + s->y * line_us;
+
+	d->front = !d->front;
+	d->flip_pending = 0;
+	flip_ctx.done = s;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [--input DEV] [--card DEV] [--connector ID] "
+		"[--count N] [--uinput] [--rate HZ] [--csv FILE]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{ "input", required_argument, NULL, 'i' },
+		{ "card", required_argument, NULL, 'c' },
+		{ "connector", required_argument, NULL, 'C' },
+		{ "count", required_argument, NULL, 'n' },
+		{ "uinput", no_argument, NULL, 'u' },
+		{ "rate", required_argument, NULL, 'r' },
+		{ "csv", required_argument, NULL, 'o' },
+		{ "help", no_argument, NULL, 'h' },
+		{ },
+	};
+	drmEventContext evctx = {
+		.version = 2,
+		.page_flip_handler = page_flip_handler,
+	};
+	struct display d = { .fd = -1 };
+	struct touch touch = { 0 };
+	struct stats interval = { 0 }, app = { 0 }, queue = { 0 }, total = { 0 };
+	struct sample *samples, *queued = NULL;
+	const char *input = NULL, *card = NULL, *csv = NULL;
+	unsigned int count = 200, n = 0, coalesced = 0, reports = 0;
+	uint32_t connector = 0;
+	char input_path[300];
+	double rate = 10;
+	int use_uinput = 0, uinput_fd = -1, in_fd, ret = 1;
+	pid_t child = -1;
+	unsigned int i;
+	int c;
+
+	while ((c = getopt_long(argc, argv, "i:c:C:n:ur:o:h", options,
+				NULL)) != -1) {
+		switch (c) {
+		case 'i':
+			input = optarg;
+			break;
+		case 'c':
+			card = optarg;
+			break;
+		case 'C':
+			connector = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		case 'u':
+			use_uinput = 1;
+			break;
+		case 'r':
+			rate = strtod(optarg, NULL);
+			break;
+		case 'o':
+			csv = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc || !count || rate <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	samples = calloc(count, sizeof(*samples));
+	interval.v = calloc(count * 64, sizeof(double));
+	app.v = calloc(count, sizeof(double));
+	queue.v = calloc(count, sizeof(double));
+	total.v = calloc(count, sizeof(double));
+	if (!samples || !interval.v || !app.v || !queue.v || !total.v) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	if (use_uinput) {
+		uinput_fd = create_uinput(input_path, sizeof(input_path));
+		if (uinput_fd < 0)
+			return 1;
+		input = input_path;
+	} else if (!input) {
+		if (find_touchscreen(input_path, sizeof(input_path))) {
+			fprintf(stderr, "no touchscreen found, use --input\n");
+			return 1;
+		}
+		input = input_path;
+	}
+
+	in_fd = open_input(input, &touch);
+	if (in_fd < 0)
+		goto out_uinput;
+
+	flip_ctx.d = &d;
+	if (open_display(&d, card, connector))
+		goto out_display;
+
+	printf("%s: waiting for %u touches\n", input, count);
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	if (use_uinput) {
+		child = fork();
+		if (child == 0)
+			inject_taps(uinput_fd, count, rate);
+	}
+
+	while (!stop && n < count) {
+		struct pollfd fds[2] = {
+			{ .fd = in_fd, .events = POLLIN },
+			{ .fd = d.fd, .events = POLLIN },
+		};
+		struct input_event ev;
+
+		if (poll(fds, 2, 5000) <= 0) {
+			if (!stop)
+				fprintf(stderr, "no touch for 5 s, giving up\n");
+			break;
+		}
+
+		if (fds[1].revents & POLLIN) {
+			flip_ctx.done = NULL;
+			drmHandleEvent(d.fd, &evctx);
+
+			if (flip_ctx.done) {
+				struct sample *s = flip_ctx.done;
+
+				stats_add(&app, s->submit_us - s->event_us);
+				stats_add(&queue, s->flip_us - s->submit_us);
+				stats_add(&total, s->photon_us - s->event_us);
+				n++;
+			}
+
+			/* A touch came in while the flip was pending */
+			if (queued && !d.flip_pending) {
+				if (submit(&d, queued))
+					break;
+				queued = NULL;
+			}
+		}
+
+		while (read(in_fd, &ev, sizeof(ev)) == sizeof(ev)) {
+			double t = ev.input_event_sec * 1e6 + ev.input_event_usec;
+			struct sample s = { 0 };
+
+			if (ev.type == EV_ABS && ev.code == ABS_X)
+				touch.x = ev.value;
+			else if (ev.type == EV_ABS && ev.code == ABS_Y)
+				touch.y = ev.value;
+			else if (ev.type == EV_KEY && ev.code == BTN_TOUCH) {
+				touch.down = ev.value;
+				if (ev.value) {
+					touch.pressed = 1;
+					touch.pressed_us = t;
+					touch.last_report_us = 0;
+				}
+			}
+
+			if (ev.type != EV_SYN || ev.code != SYN_REPORT)
+				continue;
+
+			if (touch.down) {
+				if (touch.last_report_us &&
+				    reports < count * 64)
+					stats_add(&interval,
+						  t - touch.last_report_us);
+				touch.last_report_us = t;
+				reports++;
+			}
+
+			if (!touch.pressed)
+				continue;
+			touch.pressed = 0;
+
+			s.event_us = touch.pressed_us;
+			s.x = (long)(touch.x - touch.min_x) * d.mode.hdisplay /
+			      (touch.max_x - touch.min_x + 1);
+			s.y = (long)(touch.y - touch.min_y) * d.mode.vdisplay /
+			      (touch.max_y - touch.min_y + 1);
+
+			/*
+			 * The flip in flight is always samples[n], the
+			 * queued touch samples[n + 1]
+			 */
+			if (!d.flip_pending) {
+				samples[n] = s;
+				if (submit(&d, &samples[n]))
+					goto out_child;
+			} else if (queued) {
+				/* Only the latest touch gets drawn */
+				*queued = s;
+				coalesced++;
+			} else if (n + 1 < count) {
+				samples[n + 1] = s;
+				queued = &samples[n + 1];
+			}
+		}
+	}
+
+	printf("%u samples, %u touches coalesced while a flip was pending\n",
+	       n, coalesced);
+	printf("%-16s %7s %7s %7s %7s %7s (ms)\n", "", "min", "median",
+	       "p95", "p99", "max");
+
+	if (csv) {
+		FILE *f = fopen(csv, "w");
+
+		if (f) {
+			fprintf(f, "event_us,submit_us,flip_us,photon_us,x,y\n");
+			for (i = 0; i < n; i++)
+				fprintf(f, "%.0f,%.0f,%.0f,%.0f,%d,%d\n",
+					samples[i].event_us,
+					samples[i].submit_us,
+					samples[i].flip_us,
+					samples[i].photon_us,
+					samples[i].x, samples[i].y);
+			fclose(f);
+		} else {
+			fprintf(stderr, "%s: %s\n", csv, strerror(errno));
+		}
+	}
+
+	stats_print("report interval", &interval);
+	stats_print("event to submit", &app);
+	stats_print("submit to flip", &queue);
+	stats_print("event to photon", &total);
+
+	ret = n ? 0 : 1;
+
+out_child:
+	if (child > 0) {
+		kill(child, SIGTERM);
+		waitpid(child, NULL, 0);
+	}
+out_display:
+	if (d.fd >= 0)
+		close_display(&d);
+	close(in_fd);
+out_uinput:
+	if (uinput_fd >= 0) {
+		ioctl(uinput_fd, UI_DEV_DESTROY);
+		close(uinput_fd);
+	}
+
+	return ret;
+}
@@ -0,0 +1,65 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Measure what the MPU6050 pipeline costs per second: sensor interrupts,
+# CPU time of the kernel thread draining the FIFO, and optionally the
+# wakeups and CPU time of the process reading the samples.
+#
+# Usage: imu-wakeups.sh [seconds] [reader pid]
+
+DURATION=${1:-10}
+PID=$2
+HZ=$(getconf CLK_TCK)
+
+irqs() {
+	# The hardware interrupt that inv_mpu6050 requests is named inv_mpu.
+	# The IIO trigger it fires (mpu6050-dev*) is listed too, skip it.
+	awk '$NF == "inv_mpu" { for (i = 2; i <= NF && $i ~ /^[0-9]+$/; i++) n += $i }
+	     END { print n + 0 }' /proc/interrupts
+}
+
+all_irqs() {
+	awk '/^intr/ { print $2 }' /proc/stat
+}
+
+# utime + stime of a task, in clock ticks
+ticks() {
+	[ -r "/proc/$1/stat" ] || { echo 0; return; }
+	# The comm field may contain spaces, skip past it
+	sed 's/^.*) //' "/proc/$1/stat" | awk '{ print $12 + $13 }'
+}
+
+switches() {
+	awk '/^voluntary_ctxt_switches/ { print $2 }' "/proc/$1/status" 2>/dev/null || echo 0
+}
+
+# The threaded handler of the IIO trigger, irq/NN-mpu6050_...
+thread=$(grep -l mpu6050 /proc/[0-9]*/comm 2>/dev/null | head -n 1 | cut -d/ -f3)
+
+i0=$(irqs); a0=$(all_irqs)
+t0=$(ticks "${thread:-0}")
+if [ -n "$PID" ]; then
+	p0=$(ticks "$PID"); s0=$(switches "$PID")
+fi
+
+sleep "$DURATION"
+
+i1=$(irqs); a1=$(all_irqs)
+t1=$(ticks "${thread:-0}")
+
+echo "over $DURATION s:"
+echo "  sensor interrupts:  $(( (i1 - i0) / DURATION ))/s"
+echo "  all interrupts:     $(( (a1 - a0) / DURATION ))/s"
+if [ -n "$thread" ]; then
+	echo "  FIFO thread ($(cat /proc/$thread/comm)): " \
+	     "$(( (t1 - t0) * 1000 / HZ / DURATION )) ms CPU/s"
+else
+	echo "  FIFO thread: not found, is the IIO buffer enabled?"
+fi
+
+if [ -n "$PID" ]; then
+	p1=$(ticks "$PID"); s1=$(switches "$PID")
+	echo "  reader $PID ($(cat /proc/$PID/comm 2>/dev/null)):" \
+	     "$(( (s1 - s0) / DURATION )) wakeups/s," \
+	     "$(( (p1 - p0) * 1000 / HZ / DURATION )) ms CPU/s"
+fi
@@ -0,0 +1,73 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# Set up the MPU6050 IIO buffer so that readers of /dev/iio:deviceN are
+# woken once per batch of samples instead of once per sample.
+#
+# The MPU6050 has no FIFO watermark interrupt, only data ready: the
+# inv_mpu6050 driver takes one interrupt per sample and drains the
+# hardware FIFO each time. What can be batched is the wakeup of the
+# readers, with the IIO buffer watermark, and the interrupt rate only
+# goes down with the sample rate.
+#
+# Usage: mpu6050-setup.sh [sysfs device directory]
+# Tunables, from the environment:
+#   RATE       sample rate in Hz (default 50, the driver accepts 4-1000)
+#   WATERMARK  samples per reader wakeup (default 25, 0.5 s at 50 Hz)
+#   LENGTH     buffer length in samples (default 4 * WATERMARK)
+#   CHANNELS   scan elements to enable (default "accel_x accel_y accel_z
+#              timestamp")
+#   ENABLE     1 to start the buffer (default), 0 to only configure it
+
+RATE=${RATE:-50}
+WATERMARK=${WATERMARK:-25}
+LENGTH=${LENGTH:-$((WATERMARK * 4))}
+CHANNELS=${CHANNELS:-"accel_x accel_y accel_z timestamp"}
+ENABLE=${ENABLE:-1}
+
+dev=$1
+if [ -z "$dev" ]; then
+	for d in /sys/bus/iio/devices/iio:device*; do
+		if [ "$(cat "$d/name" 2>/dev/null)" = mpu6050 ]; then
+			dev=$d
+			break
+		fi
+	done
+fi
+
+if [ -z "$dev" ] || [ ! -d "$dev" ]; then
+	echo "mpu6050: no IIO device found" >&2
+	exit 1
+fi
+
+set -e
+
+# Nothing can be changed while the buffer runs
+echo 0 > "$dev/buffer/enable"
+
+echo "$RATE" > "$dev/sampling_frequency"
+
+for f in "$dev"/scan_elements/*_en; do
+	echo 0 > "$f"
+done
+for c in $CHANNELS; do
+	echo 1 > "$dev/scan_elements/in_${c}_en"
+done
+
+# The driver's own data ready trigger
+trigger=$(cat "$dev/trigger/current_trigger")
+if [ -z "$trigger" ]; then
+	echo "$(cat "$dev/name")-dev${dev##*iio:device}" > \
+		"$dev/trigger/current_trigger"
+fi
+
+echo "$LENGTH" > "$dev/buffer/length"
+echo "$WATERMARK" > "$dev/buffer/watermark"
+
+if [ "$ENABLE" = 1 ]; then
+	echo 1 > "$dev/buffer/enable"
+fi
+
+echo "mpu6050: $(cat "$dev/sampling_frequency") Hz, watermark" \
+     "$(cat "$dev/buffer/watermark")/$(cat "$dev/buffer/length")," \
+     "buffer $(cat "$dev/buffer/enable")"
@@ -0,0 +1,518 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Screen auto-rotation from the MPU6050 accelerometer
+ *
+ * Reads the samples in binary from the IIO buffer, a batch per wakeup
+ * (see mpu6050-setup.sh for the watermark), averages each batch, turns
+ * it to the screen frame with the mount matrix and classifies the
+ * orientation with integer math only. A new orientation has to win by
+ * a margin and hold for a while before it is reported, and only
+ * changes are reported: on stdout, and through --exec to whatever sets
+ * the rotation (the compositor, xrandr, wlr-randr...).
+ *
+ * The orientations are named after the edge of the screen that is up:
+ * normal, bottom-up, left-up and right-up.
+ *
+ * --record saves the samples with their layout and mount matrix, and
+ * --replay runs the classifier on such a recording, without the sensor,
+ * in batches of --batch samples (25 by default, the setup's watermark).
+ *
+ * Build: gcc -O2 -Wall -o autorotate autorotate.c
+ * Usage: autorotate [--device DIR] [--exec CMD] [--hold MS]
+ *                   [--record FILE] [--replay FILE] [--batch N] [--verbose]
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define RECORD_MAGIC	0x524f4949	/* "IIOR" */
+#define RECORD_VERSION	1
+
+#define MAX_SAMPLE	64
+#define BATCH		256
+
+enum orientation {
+	ORIENT_UNKNOWN,
+	ORIENT_NORMAL,
+	ORIENT_BOTTOM_UP,
+	ORIENT_LEFT_UP,
+	ORIENT_RIGHT_UP,
+};
+
+static const char * const orient_names[] = {
+	[ORIENT_UNKNOWN]	= "unknown",
+	[ORIENT_NORMAL]		= "normal",
+	[ORIENT_BOTTOM_UP]	= "bottom-up",
+	[ORIENT_LEFT_UP]	= "left-up",
+	[ORIENT_RIGHT_UP]	= "right-up",
+};
+
+/* Where a channel is in the scan and how it is stored */
+struct channel {
+	uint8_t offset;
+	uint8_t bytes;
+	uint8_t bits;
+	uint8_t shift;
+	uint8_t is_signed;
+	uint8_t big_endian;
+	uint8_t enabled;
+	uint8_t pad;
+};
+
+enum { CH_X, CH_Y, CH_Z, CH_TIMESTAMP, CH_NUM };
+
+static const char * const ch_names[CH_NUM] = {
+	"accel_x", "accel_y", "accel_z", "timestamp",
+};
+
+/* Layout of the samples, also the header of the recordings */
+struct layout {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sample_size;
+	/* Mount matrix, row major, in thousandths */
+	int32_t matrix[9];
+	struct channel ch[CH_NUM];
+};
+
+struct classifier {
+	enum orientation current;
+	enum orientation candidate;
+	int64_t candidate_since;
+	int64_t hold_ns;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static int read_sysfs(const char *dir, const char *name, char *buf,
+		      size_t len)
+{
+	char path[512];
+	ssize_t n;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+
+	n = read(fd, buf, len - 1);
+	close(fd);
+	if (n < 0)
+		return -errno;
+
+	buf[n] = '\0';
+	buf[strcspn(buf, "\n")] = '\0';
+
+	return 0;
+}
+
+static int find_device(char *dir, size_t len)
+{
+	struct dirent *d;
+	DIR *iio;
+	int ret = -ENODEV;
+
+	iio = opendir("/sys/bus/iio/devices");
+	if (!iio)
+		return -errno;
+
+	while ((d = readdir(iio))) {
+		char path[300], name[32];
+
+		if (strncmp(d->d_name, "iio:device", 10))
+			continue;
+
+		snprintf(path, sizeof(path), "/sys/bus/iio/devices/%s",
+			 d->d_name);
+		if (!read_sysfs(path, "name", name, sizeof(name)) &&
+		    !strcmp(name, "mpu6050")) {
+			snprintf(dir, len, "%s", path);
+			ret = 0;
+			break;
+		}
+	}
+	closedir(iio);
+
+	return ret;
+}
+
+/* "1, 0, 0; 0, -1, 0; 0, 0, 1" */
+static void parse_matrix(const char *s, int32_t *m)
+{
+	int i;
+
+	for (i = 0; i < 9; i++) {
+		char *end;
+		double v = strtod(s, &end);
+
+		if (end == s)
+			break;
+		m[i] = v * 1000;
+		s = end + strspn(end, ",; ");
+	}
+
+	/* Identity if the matrix is missing or malformed */
+	if (i != 9)
+		for (i = 0; i < 9; i++)
+			m[i] = i % 4 ? 0 : 1000;
+}
+
+/*
+ * The channels are laid out by index, each one aligned to its own
+ * storage size, and the whole scan to the largest one.
+ */
+static int read_layout(const char *dir, struct layout *l)
+{
+	int index[CH_NUM], order[CH_NUM], i, j, n = 0;
+	unsigned int offset = 0, align = 1;
+	char buf[128], name[64];
+
+	memset(l, 0, sizeof(*l));
+	l->magic = RECORD_MAGIC;
+	l->version = RECORD_VERSION;
+
+	if (read_sysfs(dir, "in_accel_mount_matrix", buf, sizeof(buf)) &&
+	    read_sysfs(dir, "mount_matrix", buf, sizeof(buf)))
+		buf[0] = '\0';
+	parse_matrix(buf, l->matrix);
+
+	for (i = 0; i < CH_NUM; i++) {
+		struct channel *c = &l->ch[i];
+		char endian[3], sign;
+		unsigned int bits, storage, shift;
+
+		snprintf(name, sizeof(name), "scan_elements/in_%s_en",
+			 ch_names[i]);
+		if (read_sysfs(dir, name, buf, sizeof(buf)) || buf[0] != '1')
+			continue;
+
+		snprintf(name, sizeof(name), "scan_elements/in_%s_index",
+			 ch_names[i]);
+		if (read_sysfs(dir, name, buf, sizeof(buf)))
+			return -EINVAL;
+		index[i] = atoi(buf);
+
+		/* e.g. "be:s16/16>>0" */
+		snprintf(name, sizeof(name), "scan_elements/in_%s_type",
+			 ch_names[i]);
+		if (read_sysfs(dir, name, buf, sizeof(buf)) ||
+		    sscanf(buf, "%2[bl]e:%c%u/%u>>%u", endian, &sign, &bits,
+			   &storage, &shift) != 5 ||
+		    storage % 8 || storage > 64)
+			return -EINVAL;
+
+		c->enabled = 1;
+		c->big_endian = endian[0] == 'b';
+		c->is_signed = sign == 's';
+		c->bits = bits;
+		c->bytes = storage / 8;
+		c->shift = shift;
+		order[n++] = i;
+	}
+
+	/* Sort the enabled channels by scan index */
+	for (i = 1; i < n; i++)
+		for (j = i; j > 0 && index[order[j]] < index[order[j - 1]]; j--) {
+			int t = order[j];
+
+			order[j] = order[j - 1];
+			order[j - 1] = t;
+		}
+
+	for (i = 0; i < n; i++) {
+		struct channel *c = &l->ch[order[i]];
+
+		offset = (offset + c->bytes - 1) / c->bytes * c->bytes;
+		c->offset = offset;
+		offset += c->bytes;
+		if (c->bytes > align)
+			align = c->bytes;
+	}
+	l->sample_size = (offset + align - 1) / align * align;
+
+	if (!l->ch[CH_X].enabled || !l->ch[CH_Y].enabled ||
+	    !l->ch[CH_Z].enabled || l->sample_size > MAX_SAMPLE)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int64_t get_channel(const struct channel *c, const uint8_t *sample)
+{
+	uint64_t v = 0;
+	int i;
+
+	for (i = 0; i < c->bytes; i++) {
+		int b = c->big_endian ? i : c->bytes - 1 - i;
+
+		v = v << 8 | sample[c->offset + b];
+	}
+
+	v >>= c->shift;
+	if (c->bits < 64) {
+		v &= (UINT64_C(1) << c->bits) - 1;
+		if (c->is_signed && (v >> (c->bits - 1)))
+			v |= ~((UINT64_C(1) << c->bits) - 1);
+	}
+
+	return (int64_t)v;
+}
+
+static int64_t iabs(int64_t v)
+{
+	return v < 0 ? -v : v;
+}
+
+/*
+ * Classify the average gravity vector of a batch, in the screen frame.
+ * Returns the new orientation, or ORIENT_UNKNOWN if it didn't change.
+ */
+static enum orientation classify(struct classifier *cl, const int64_t *g,
+				 int64_t now)
+{
+	int64_t ax = iabs(g[0]), ay = iabs(g[1]), az = iabs(g[2]);
+	enum orientation o;
+
+	/* Lying flat, more than 45 degrees from upright: keep the current one */
+	if (az * az > ax * ax + ay * ay) {
+		cl->candidate = ORIENT_UNKNOWN;
+		return ORIENT_UNKNOWN;
+	}
+
+	if (ay >= ax)
+		o = g[1] > 0 ? ORIENT_NORMAL : ORIENT_BOTTOM_UP;
+	else
+		o = g[0] > 0 ? ORIENT_RIGHT_UP : ORIENT_LEFT_UP;
+
+	/*
+	 * Hysteresis: leaving the current orientation takes a dominant
+	 * axis 1.5 times the other one, about 56 degrees instead of 45.
+	 */
+	if (o == cl->current ||
+	    (ay >= ax ? 2 * ay < 3 * ax : 2 * ax < 3 * ay)) {
+		cl->candidate = ORIENT_UNKNOWN;
+		return ORIENT_UNKNOWN;
+	}
+
+	if (o != cl->candidate) {
+		cl->candidate = o;
+		cl->candidate_since = now;
+	}
+
+	/* The first orientation is taken as is */
+	if (cl->current != ORIENT_UNKNOWN &&
+	    now - cl->candidate_since < cl->hold_ns)
+		return ORIENT_UNKNOWN;
+
+	cl->current = o;
+	cl->candidate = ORIENT_UNKNOWN;
+
+	return o;
+}
+
+static void run_exec(const char *cmd, enum orientation o)
+{
+	pid_t pid = fork();
+
+	if (pid == 0) {
+		execl("/bin/sh", "sh", "-c", cmd, "autorotate",
+		      orient_names[o], (char *)NULL);
+		_exit(127);
+	}
+	if (pid > 0)
+		waitpid(pid, NULL, 0);
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [--device DIR] [--exec CMD] [--hold MS] "
+		"[--record FILE] [--replay FILE] [--batch N] [--verbose]\n",
+		name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{ "device", required_argument, NULL, 'd' },
+		{ "exec", required_argument, NULL, 'e' },
+		{ "hold", required_argument, NULL, 'H' },
+		{ "record", required_argument, NULL, 'r' },
+		{ "replay", required_argument, NULL, 'p' },
+		{ "batch", required_argument, NULL, 'b' },
+		{ "verbose", no_argument, NULL, 'v' },
+		{ "help", no_argument, NULL, 'h' },
+		{ },
+	};
+	struct classifier cl = { .hold_ns = 300 * 1000000LL };
+	const char *device = NULL, *exec = NULL, *record = NULL;
+	const char *replay = NULL;
+	static uint8_t buf[BATCH * MAX_SAMPLE];
+	int64_t samples = 0, batches = 0, changes = 0;
+	char dir[300], node[64];
+	struct layout l;
+	FILE *rec = NULL;
+	int verbose = 0, batch = BATCH, fd, c;
+
+	while ((c = getopt_long(argc, argv, "d:e:H:r:p:b:vh", options,
+				NULL)) != -1) {
+		switch (c) {
+		case 'd':
+			device = optarg;
+			break;
+		case 'e':
+			exec = optarg;
+			break;
+		case 'H':
+			cl.hold_ns = strtoll(optarg, NULL, 0) * 1000000LL;
+			break;
+		case 'r':
+			record = optarg;
+			break;
+		case 'p':
+			replay = optarg;
+			batch = 25;
+			break;
+		case 'b':
+			batch = strtol(optarg, NULL, 0);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc || batch < 1 || batch > BATCH) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (replay) {
+		fd = open(replay, O_RDONLY);
+		if (fd < 0 || read(fd, &l, sizeof(l)) != sizeof(l) ||
+		    l.magic != RECORD_MAGIC || l.version != RECORD_VERSION ||
+		    !l.sample_size || l.sample_size > MAX_SAMPLE) {
+			fprintf(stderr, "%s: not a recording\n", replay);
+			return 1;
+		}
+	} else {
+		if (device)
+			snprintf(dir, sizeof(dir), "%s", device);
+		else if (find_device(dir, sizeof(dir))) {
+			fprintf(stderr, "no mpu6050 IIO device found\n");
+			return 1;
+		}
+
+		if (read_layout(dir, &l)) {
+			fprintf(stderr, "%s: the accel channels aren't enabled, "
+				"run mpu6050-setup.sh first\n", dir);
+			return 1;
+		}
+
+		snprintf(node, sizeof(node), "/dev/%s", strrchr(dir, '/') + 1);
+		fd = open(node, O_RDONLY);
+		if (fd < 0) {
+			fprintf(stderr, "%s: %s\n", node, strerror(errno));
+			return 1;
+		}
+	}
+
+	if (record) {
+		rec = fopen(record, "wb");
+		if (!rec || fwrite(&l, sizeof(l), 1, rec) != 1) {
+			fprintf(stderr, "%s: %s\n", record, strerror(errno));
+			return 1;
+		}
+	}
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	while (!stop) {
+		int64_t raw[3] = { 0 }, g[3], now;
+		ssize_t len;
+		int i, j, n;
+
+		/* Blocks until the watermark is reached */
+		len = read(fd, buf, batch * l.sample_size);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len < 0) {
+			fprintf(stderr, "read: %s\n", strerror(errno));
+			break;
+		}
+
+		n = len / l.sample_size;
+		if (!n)
+			break;
+
+		if (rec)
+			fwrite(buf, l.sample_size, n, rec);
+
+		for (i = 0; i < n; i++)
+			for (j = 0; j < 3; j++)
+				raw[j] += get_channel(&l.ch[CH_X + j],
+						      buf + i * l.sample_size);
+
+		/* To the screen frame, still scaled by 1000 */
+		for (i = 0; i < 3; i++) {
+			g[i] = 0;
+			for (j = 0; j < 3; j++)
+				g[i] += l.matrix[i * 3 + j] * (raw[j] / n);
+		}
+
+		/* Without timestamps, count on the debounce in batches */
+		if (l.ch[CH_TIMESTAMP].enabled)
+			now = get_channel(&l.ch[CH_TIMESTAMP],
+					  buf + (n - 1) * l.sample_size);
+		else
+			now = batches * cl.hold_ns / 2;
+
+		samples += n;
+		batches++;
+
+		if (verbose)
+			printf("%lld: %d samples, g %lld %lld %lld\n",
+			       (long long)now, n, (long long)g[0] / 1000,
+			       (long long)g[1] / 1000, (long long)g[2] / 1000);
+
+		if (classify(&cl, g, now) != ORIENT_UNKNOWN) {
+			changes++;
+			printf("%s\n", orient_names[cl.current]);
+			fflush(stdout);
+
+			if (exec)
+				run_exec(exec, cl.current);
+		}
+	}
+
+	if (rec)
+		fclose(rec);
+	close(fd);
+
+	if (replay || verbose)
+		fprintf(stderr, "%lld samples in %lld batches, %lld changes\n",
+			(long long)samples, (long long)batches,
+			(long long)changes);
+
+	return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0
+#
+# How long the firmware spent loading the device tree and its overlays
+# on the last boot, from the VideoCore log. Run it once with the split
+# overlays and once with the cutiepi overlay, after a cold boot each.
+#
+# Usage: overlay-boot-time.sh [log file]
+#   without a file, the log is read with "vcdbg log msg" (needs root)
+
+if [ -n "$1" ]; then
+	log=$(cat "$1")
+else
+	log=$(vcdbg log msg 2>&1)
+fi
+
+# Lines look like "002071.213: brfs: File read: /mfs/sd/overlays/x.dtbo",
+# the timestamp is in ms since the firmware started
+echo "$log" | awk '
+	/\.dtb|\.dtbo|[Ll]oaded overlay|dtparam|dtoverlay/ {
+		t = $1; sub(":", "", t); t += 0
+		if (!first) first = t
+		last = t
+		print
+		if (/[Ll]oaded overlay/)
+			overlays++
+	}
+	/[Ss]tarting kernel|[Kk]ernel start/ && !kernel {
+		t = $1; sub(":", "", t); kernel = t + 0
+	}
+	END {
+		if (!first) {
+			print "no device tree activity in the log"
+			exit 1
+		}
+		printf "\n%d overlays, %.3f ms from the first device tree read " \
+		       "to the last overlay\n", overlays, last - first
+		if (kernel)
+			printf "kernel started at %.3f ms\n", kernel
+	}'